@@ -0,0 +1,590 @@
+// 寻路基准测试（无窗口运行）
+// 在程序生成的几种障碍布局上批量执行寻路查询，统计延迟、扩展节点数、内存分配次数，
+// 并与全图Dijkstra的最优代价比较；逐格搜索按智能程度和迭代上限分组，单独统计因迭代上限终止的查询
+// 结果写入JSON文件，便于跟踪性能回归
+//
+// 用法: pathfinding_bench [输出文件=pathfinding_bench.json] [每组查询数=1000] [随机种子=12345]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "Constants.h"
+#include "Game.h"
+#include "Map.h"
+#include "Grid.h"
+#include "Tile.h"
+#include "Pathfinding.h"
+#include "HierarchicalPathfinder.h"
+
+// 统计全局内存分配次数（只计数，不改变分配行为）
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// 无窗口运行时没有Game实例（地图和方块只在渲染时访问它）
+Game* Game::getInstance() {
+    return nullptr;
+}
+
+namespace {
+    constexpr int CHUNKS = 8;                                        // 地图边长（网格数）
+    constexpr int SIDE = CHUNKS * GameConstants::MAP_GRID_SIZE;      // 地图边长（方块数）
+    constexpr int SHORT_MIN_DISTANCE = 4;                            // 近距离查询的切比雪夫距离范围
+    constexpr int SHORT_MAX_DISTANCE = HierarchicalPathfinder::MIN_HIERARCHICAL_DISTANCE - 1;
+    constexpr int LONG_MIN_DISTANCE = HierarchicalPathfinder::MIN_HIERARCHICAL_DISTANCE;
+    constexpr int LONG_MAX_DISTANCE = SIDE - 2;
+    const float INTELLIGENCE_LEVELS[] = {1.2f, 2.5f, 8.0f};          // 与游戏中丧尸的智能程度范围一致
+    constexpr int NO_ITERATION_LIMIT = std::numeric_limits<int>::max();
+    // AStar的迭代上限（游戏使用默认值），不限制时只受智能限制和搜索窗口约束
+    const int ITERATION_LIMITS[] = {1000, 2500, PathfindingRequest::DEFAULT_MAX_ITERATIONS, NO_ITERATION_LIMIT};
+
+    // 障碍布局：blocked为不可通行方块，cost为可通行方块的地形耗时
+    struct Layout {
+        std::string name;
+        std::vector<uint8_t> blocked;
+        std::vector<float> cost;
+
+        explicit Layout(const std::string& layoutName)
+            : name(layoutName), blocked(SIDE * SIDE, 0), cost(SIDE * SIDE, 100.0f) {}
+
+        uint8_t& blockedAt(int x, int y) { return blocked[y * SIDE + x]; }
+        float& costAt(int x, int y) { return cost[y * SIDE + x]; }
+
+        // 地图外未加载区域可通行，用一圈障碍把查询限制在布局内
+        void closeBorder() {
+            for (int i = 0; i < SIDE; ++i) {
+                blockedAt(i, 0) = blockedAt(i, SIDE - 1) = 1;
+                blockedAt(0, i) = blockedAt(SIDE - 1, i) = 1;
+            }
+        }
+    };
+
+    // 开阔地：少量零散障碍和高耗时地形
+    Layout makeOpenField(std::mt19937& rng) {
+        Layout layout("open_field");
+        std::uniform_int_distribution<> percent(0, 99);
+        for (int i = 0; i < SIDE * SIDE; ++i) {
+            int roll = percent(rng);
+            if (roll < 8) {
+                layout.blocked[i] = 1;
+            } else if (roll < 18) {
+                layout.cost[i] = 200.0f;
+            }
+        }
+        layout.closeBorder();
+        return layout;
+    }
+
+    // 迷宫：深度优先生成的单格通道迷宫，再随机打通少量墙壁形成环路
+    Layout makeMaze(std::mt19937& rng) {
+        Layout layout("maze");
+        std::fill(layout.blocked.begin(), layout.blocked.end(), 1);
+
+        const int cells = (SIDE - 1) / 2;
+        std::vector<uint8_t> visited(cells * cells, 0);
+        std::vector<std::pair<int, int>> stack{{0, 0}};
+        visited[0] = 1;
+        layout.blockedAt(1, 1) = 0;
+
+        static const int directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        while (!stack.empty()) {
+            auto [cellX, cellY] = stack.back();
+            int order[4] = {0, 1, 2, 3};
+            std::shuffle(order, order + 4, rng);
+
+            bool advanced = false;
+            for (int i : order) {
+                int nextX = cellX + directions[i][0];
+                int nextY = cellY + directions[i][1];
+                if (nextX < 0 || nextY < 0 || nextX >= cells || nextY >= cells || visited[nextY * cells + nextX]) {
+                    continue;
+                }
+                visited[nextY * cells + nextX] = 1;
+                layout.blockedAt(2 * cellX + 1 + directions[i][0], 2 * cellY + 1 + directions[i][1]) = 0;
+                layout.blockedAt(2 * nextX + 1, 2 * nextY + 1) = 0;
+                stack.emplace_back(nextX, nextY);
+                advanced = true;
+                break;
+            }
+            if (!advanced) {
+                stack.pop_back();
+            }
+        }
+
+        std::uniform_int_distribution<> coord(1, SIDE - 2);
+        for (int i = 0; i < SIDE * SIDE / 40; ++i) {
+            layout.blockedAt(coord(rng), coord(rng)) = 0;
+        }
+        layout.closeBorder();
+        return layout;
+    }
+
+    // 房间：16×16的房间，墙上各开一个两格宽的门，房间内有高耗时地形
+    Layout makeRooms(std::mt19937& rng) {
+        Layout layout("rooms");
+        const int roomSize = 16;
+        std::uniform_int_distribution<> door(2, roomSize - 3);
+        std::uniform_int_distribution<> percent(0, 99);
+
+        for (int y = 0; y < SIDE; ++y) {
+            for (int x = 0; x < SIDE; ++x) {
+                if (x % roomSize == 0 || y % roomSize == 0) {
+                    layout.blockedAt(x, y) = 1;
+                } else if (percent(rng) < 12) {
+                    layout.costAt(x, y) = 300.0f;
+                }
+            }
+        }
+
+        for (int roomY = 0; roomY * roomSize < SIDE; ++roomY) {
+            for (int roomX = 0; roomX * roomSize < SIDE; ++roomX) {
+                int baseX = roomX * roomSize;
+                int baseY = roomY * roomSize;
+                int doorX = baseX + door(rng);
+                int doorY = baseY + door(rng);
+                if (doorX + 1 < SIDE) {
+                    layout.blockedAt(doorX, baseY) = layout.blockedAt(doorX + 1, baseY) = 0;
+                }
+                if (doorY + 1 < SIDE) {
+                    layout.blockedAt(baseX, doorY) = layout.blockedAt(baseX, doorY + 1) = 0;
+                }
+            }
+        }
+        layout.closeBorder();
+        return layout;
+    }
+
+    // 测试地形：与Game::generateTestTerrain相同的分布（30%的方块中一半为test_brick，一半为test_hard）
+    Layout makeTestTerrain(std::mt19937& rng) {
+        Layout layout("test_terrain");
+        std::uniform_int_distribution<> placeDis(0, 100);
+        std::uniform_int_distribution<> tileDis(0, 1);
+        for (int i = 0; i < SIDE * SIDE; ++i) {
+            if (placeDis(rng) < 30) {
+                if (tileDis(rng) == 0) {
+                    layout.blocked[i] = 1;
+                } else {
+                    layout.cost[i] = 500.0f;
+                }
+            }
+        }
+        layout.closeBorder();
+        return layout;
+    }
+
+    // 把布局写入真实的Map/Grid/Tile，寻路走与游戏相同的查询路径
+    std::unique_ptr<Map> buildMap(const Layout& layout) {
+        auto map = std::make_unique<Map>(nullptr, CHUNKS);
+        const int gridSize = GameConstants::MAP_GRID_SIZE;
+        const int tileSize = GameConstants::TILE_SIZE;
+
+        for (int gridY = 0; gridY < CHUNKS; ++gridY) {
+            for (int gridX = 0; gridX < CHUNKS; ++gridX) {
+                int worldX, worldY;
+                Map::gridCoordToWorld(gridX, gridY, worldX, worldY);
+                auto grid = std::make_unique<Grid>("BenchGrid", worldX, worldY, gridSize, tileSize);
+
+                for (int localY = 0; localY < gridSize; ++localY) {
+                    for (int localX = 0; localX < gridSize; ++localX) {
+                        int index = (gridY * gridSize + localY) * SIDE + gridX * gridSize + localX;
+                        if (layout.blocked[index]) {
+                            grid->addTile(Tile("test_brick", "assets/tiles/brick.bmp", true, true, true,
+                                               0, 0, tileSize, 100.0f), localX, localY);
+                        } else if (layout.cost[index] != 100.0f) {
+                            grid->addTile(Tile("test_hard", "assets/tiles/grassland2.bmp", false, true, false,
+                                               0, 0, tileSize, layout.cost[index]), localX, localY);
+                        }
+                    }
+                }
+                map->addGrid(std::move(grid), gridX, gridY);
+            }
+        }
+        return map;
+    }
+
+    struct Query {
+        int startX, startY;
+        int targetX, targetY;
+    };
+
+    // 随机生成切比雪夫距离在[minDistance, maxDistance]内、起点终点都可通行的查询
+    std::vector<Query> makeQueries(const Layout& layout, std::mt19937& rng, int count, int minDistance, int maxDistance) {
+        std::vector<Query> queries;
+        std::uniform_int_distribution<> coord(1, SIDE - 2);
+        std::uniform_int_distribution<> offset(-maxDistance, maxDistance);
+        while (static_cast<int>(queries.size()) < count) {
+            Query query{coord(rng), coord(rng), 0, 0};
+            query.targetX = query.startX + offset(rng);
+            query.targetY = query.startY + offset(rng);
+            int distance = std::max(std::abs(query.targetX - query.startX), std::abs(query.targetY - query.startY));
+            if (distance < minDistance || query.targetX < 1 || query.targetY < 1 ||
+                query.targetX > SIDE - 2 || query.targetY > SIDE - 2 ||
+                layout.blocked[query.startY * SIDE + query.startX] ||
+                layout.blocked[query.targetY * SIDE + query.targetX]) {
+                continue;
+            }
+            queries.push_back(query);
+        }
+        return queries;
+    }
+
+    // 参考Dijkstra：与AStar相同的可通行性、8方向移动和代价，不限制搜索范围
+    class ReferenceDijkstra {
+    private:
+        const AStar& astar;
+        std::vector<float> distance;
+        std::vector<std::pair<float, int>> heap;
+
+    public:
+        explicit ReferenceDijkstra(const AStar& pathfinder) : astar(pathfinder) {}
+
+        // 返回最优代价，不可达返回-1
+        float solve(const Query& query) {
+            const float unreachable = std::numeric_limits<float>::max();
+            distance.assign(SIDE * SIDE, unreachable);
+            heap.clear();
+
+            int start = query.startY * SIDE + query.startX;
+            int target = query.targetY * SIDE + query.targetX;
+            distance[start] = 0.0f;
+            heap.emplace_back(0.0f, start);
+            std::greater<std::pair<float, int>> compare;
+
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), compare);
+                auto [value, index] = heap.back();
+                heap.pop_back();
+                if (value > distance[index]) continue;
+                if (index == target) return value;
+
+                int x = index % SIDE;
+                int y = index / SIDE;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= SIDE || ny >= SIDE) continue;
+                        if (!astar.isWalkable(nx, ny)) continue;
+
+                        float candidate = value + astar.getMoveCost(x, y, nx, ny);
+                        int neighbor = ny * SIDE + nx;
+                        if (candidate < distance[neighbor]) {
+                            distance[neighbor] = candidate;
+                            heap.emplace_back(candidate, neighbor);
+                            std::push_heap(heap.begin(), heap.end(), compare);
+                        }
+                    }
+                }
+            }
+            return -1.0f;
+        }
+    };
+
+    // 逐格路径的代价（AStar输出的未平滑路径相邻点为相邻方块）
+    float pathCost(const AStar& astar, const std::vector<PathPoint>& path) {
+        float cost = 0.0f;
+        for (size_t i = 1; i < path.size(); ++i) {
+            cost += astar.getMoveCost(static_cast<int>(path[i - 1].x) / GameConstants::TILE_SIZE,
+                                      static_cast<int>(path[i - 1].y) / GameConstants::TILE_SIZE,
+                                      static_cast<int>(path[i].x) / GameConstants::TILE_SIZE,
+                                      static_cast<int>(path[i].y) / GameConstants::TILE_SIZE);
+        }
+        return cost;
+    }
+
+    double percentile(std::vector<double> values, double fraction) {
+        if (values.empty()) return 0.0;
+        size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    double mean(const std::vector<double>& values) {
+        if (values.empty()) return 0.0;
+        double sum = 0.0;
+        for (double value : values) sum += value;
+        return sum / values.size();
+    }
+
+    nlohmann::json summarize(const std::vector<double>& values) {
+        return {
+            {"p50", percentile(values, 0.50)},
+            {"p99", percentile(values, 0.99)},
+            {"max", values.empty() ? 0.0 : *std::max_element(values.begin(), values.end())},
+            {"mean", mean(values)}
+        };
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsedMicros(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double, std::micro>(end - start).count();
+    }
+
+    // 一组查询的统计
+    struct SolverStats {
+        std::vector<double> latency;         // 微秒
+        std::vector<double> expanded;        // 扩展节点数（只有逐格搜索有）
+        std::vector<double> allocations;     // 每次查询的分配次数
+        std::vector<double> optimality;      // 路径代价 / 最优代价
+        std::vector<double> smoothLatency;
+        double pointsBefore = 0.0;
+        double pointsAfter = 0.0;
+        int success = 0;
+        int missed = 0;                      // 参考Dijkstra可达但寻路失败
+        int unreachable = 0;                 // 参考Dijkstra也不可达
+        int iterationLimit = -1;             // AStar迭代上限（-1表示不适用）
+        int iterationLimitHits = 0;          // 因迭代上限终止的查询数
+        int missedByIterationLimit = 0;      // 其中参考Dijkstra可达的（计入missed）
+
+        nlohmann::json toJson(const std::string& solver, float intelligence, size_t queryCount) const {
+            nlohmann::json result = {
+                {"solver", solver},
+                {"intelligence", intelligence},
+                {"queries", queryCount},
+                {"success", success},
+                {"missed", missed},
+                {"unreachable", unreachable},
+                {"latencyUs", summarize(latency)},
+                {"allocationsPerQuery", summarize(allocations)},
+                {"smoothing", {
+                    {"latencyUs", summarize(smoothLatency)},
+                    {"pointsBefore", success ? pointsBefore / success : 0.0},
+                    {"pointsAfter", success ? pointsAfter / success : 0.0}
+                }}
+            };
+            if (!expanded.empty()) {
+                result["expandedNodes"] = summarize(expanded);
+            }
+            if (iterationLimit >= 0) {
+                // 不限制时记为null
+                result["iterationLimit"] = iterationLimit == NO_ITERATION_LIMIT ? nlohmann::json(nullptr)
+                                                                                : nlohmann::json(iterationLimit);
+                result["iterationLimitHits"] = iterationLimitHits;
+                result["missedByIterationLimit"] = missedByIterationLimit;
+            }
+            if (!optimality.empty()) {
+                size_t suboptimal = std::count_if(optimality.begin(), optimality.end(),
+                                                  [](double ratio) { return ratio > 1.001; });
+                result["optimality"] = {
+                    {"mean", mean(optimality)},
+                    {"max", *std::max_element(optimality.begin(), optimality.end())},
+                    {"suboptimal", suboptimal}
+                };
+            }
+            return result;
+        }
+    };
+
+    void printStats(const std::string& layout, const std::string& solver, float intelligence, const SolverStats& stats) {
+        std::string limit = stats.iterationLimit < 0 ? "-"
+                          : stats.iterationLimit == NO_ITERATION_LIMIT ? "none"
+                          : std::to_string(stats.iterationLimit);
+        std::printf("%-13s %-12s int=%.1f cap=%-5s  ok=%4d missed=%4d capped=%4d  p50=%8.1fus p99=%8.1fus  nodes p50=%7.0f  allocs=%5.1f  opt=%.4f\n",
+                    layout.c_str(), solver.c_str(), intelligence, limit.c_str(), stats.success, stats.missed,
+                    stats.iterationLimitHits,
+                    percentile(stats.latency, 0.5), percentile(stats.latency, 0.99),
+                    percentile(stats.expanded, 0.5), mean(stats.allocations),
+                    stats.optimality.empty() ? 0.0 : mean(stats.optimality));
+    }
+
+    // 逐格搜索（A*或跳点搜索）
+    SolverStats runFlatSearch(const AStar& astar, const std::vector<Query>& queries, const std::vector<float>& optimal,
+                              float intelligence, PathSearchMode mode, int iterationLimit) {
+        SolverStats stats;
+        stats.iterationLimit = iterationLimit;
+        PathSearchContext context;
+        std::vector<PathPoint> path;
+
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const Query& query = queries[i];
+            PathfindingRequest request(query.startX, query.startY, query.targetX, query.targetY, intelligence, mode,
+                                       iterationLimit);
+
+            size_t allocationsBefore = allocationCount.load();
+            auto start = Clock::now();
+            PathfindingResult result = astar.findPath(request, context, path);
+            auto end = Clock::now();
+            stats.allocations.push_back(static_cast<double>(allocationCount.load() - allocationsBefore));
+            stats.latency.push_back(elapsedMicros(start, end));
+            stats.expanded.push_back(context.getExpandedCount());
+
+            if (optimal[i] < 0.0f) {
+                stats.unreachable++;
+            }
+            if (result != PathfindingResult::SUCCESS) {
+                bool capped = context.reachedIterationLimit();
+                if (capped) stats.iterationLimitHits++;
+                if (optimal[i] >= 0.0f) {
+                    stats.missed++;
+                    if (capped) stats.missedByIterationLimit++;
+                }
+                continue;
+            }
+
+            stats.success++;
+            if (optimal[i] > 0.0f) {
+                stats.optimality.push_back(pathCost(astar, path) / optimal[i]);
+            }
+
+            stats.pointsBefore += path.size();
+            auto smoothStart = Clock::now();
+            astar.smoothPath(path, context);
+            stats.smoothLatency.push_back(elapsedMicros(smoothStart, Clock::now()));
+            stats.pointsAfter += path.size();
+        }
+        return stats;
+    }
+
+    // 分层寻路（只细化前几段，路径代价不可直接与最优代价比较）
+    SolverStats runHierarchical(HierarchicalPathfinder& hierarchical, const AStar& astar, const std::vector<Query>& queries,
+                                const std::vector<float>& optimal, float intelligence) {
+        SolverStats stats;
+        PathSearchContext context;
+        std::vector<PathPoint> path;
+
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const Query& query = queries[i];
+            PathfindingRequest request(query.startX, query.startY, query.targetX, query.targetY, intelligence,
+                                       PathSearchMode::JUMP_POINT);
+
+            size_t allocationsBefore = allocationCount.load();
+            auto start = Clock::now();
+            PathfindingResult result = hierarchical.findPath(request, astar, path);
+            auto end = Clock::now();
+            stats.allocations.push_back(static_cast<double>(allocationCount.load() - allocationsBefore));
+            stats.latency.push_back(elapsedMicros(start, end));
+
+            if (optimal[i] < 0.0f) {
+                stats.unreachable++;
+            }
+            if (result != PathfindingResult::SUCCESS) {
+                if (optimal[i] >= 0.0f) stats.missed++;
+                continue;
+            }
+
+            stats.success++;
+            stats.pointsBefore += path.size();
+            auto smoothStart = Clock::now();
+            astar.smoothPath(path, context);
+            stats.smoothLatency.push_back(elapsedMicros(smoothStart, Clock::now()));
+            stats.pointsAfter += path.size();
+        }
+        return stats;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputPath = argc > 1 ? argv[1] : "pathfinding_bench.json";
+    int queryCount = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000;
+    unsigned int seed = argc > 3 ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 12345u;
+
+    std::mt19937 rng(seed);
+    std::vector<std::function<Layout(std::mt19937&)>> generators = {
+        makeOpenField, makeMaze, makeRooms, makeTestTerrain
+    };
+
+    nlohmann::json report = {
+        {"seed", seed},
+        {"queriesPerSet", queryCount},
+        {"mapTiles", SIDE},
+        {"layouts", nlohmann::json::array()}
+    };
+
+    for (const auto& generate : generators) {
+        Layout layout = generate(rng);
+        std::unique_ptr<Map> map = buildMap(layout);
+        AStar astar(map.get());
+        HierarchicalPathfinder hierarchical(map.get());
+        ReferenceDijkstra reference(astar);
+
+        size_t blockedCount = std::count(layout.blocked.begin(), layout.blocked.end(), 1);
+        nlohmann::json layoutReport = {
+            {"name", layout.name},
+            {"blockedRatio", static_cast<double>(blockedCount) / (SIDE * SIDE)},
+            {"results", nlohmann::json::array()}
+        };
+
+        // 近距离查询：CreaturePathfinder交给逐格搜索的距离范围
+        std::vector<Query> shortQueries = makeQueries(layout, rng, queryCount, SHORT_MIN_DISTANCE, SHORT_MAX_DISTANCE);
+        std::vector<float> shortOptimal;
+        for (const Query& query : shortQueries) {
+            shortOptimal.push_back(reference.solve(query));
+        }
+
+        for (float intelligence : INTELLIGENCE_LEVELS) {
+            for (PathSearchMode mode : {PathSearchMode::ASTAR, PathSearchMode::JUMP_POINT}) {
+                std::string solver = mode == PathSearchMode::ASTAR ? "astar" : "jump_point";
+                for (int iterationLimit : ITERATION_LIMITS) {
+                    SolverStats stats = runFlatSearch(astar, shortQueries, shortOptimal, intelligence, mode, iterationLimit);
+                    printStats(layout.name, solver, intelligence, stats);
+                    nlohmann::json entry = stats.toJson(solver, intelligence, shortQueries.size());
+                    entry["distance"] = "short";
+                    layoutReport["results"].push_back(entry);
+                }
+            }
+        }
+
+        // 远距离查询：分层寻路与逐格跳点搜索对比（使用最高智能程度，避免智能限制掩盖差异）
+        std::vector<Query> longQueries = makeQueries(layout, rng, queryCount, LONG_MIN_DISTANCE, LONG_MAX_DISTANCE);
+        std::vector<float> longOptimal;
+        for (const Query& query : longQueries) {
+            longOptimal.push_back(reference.solve(query));
+        }
+
+        // 远距离时搜索窗口最大，迭代上限最可能先于智能限制终止搜索
+        const float longIntelligence = INTELLIGENCE_LEVELS[2];
+        for (int iterationLimit : ITERATION_LIMITS) {
+            SolverStats flatStats = runFlatSearch(astar, longQueries, longOptimal, longIntelligence,
+                                                  PathSearchMode::JUMP_POINT, iterationLimit);
+            printStats(layout.name, "jump_point", longIntelligence, flatStats);
+            nlohmann::json flatEntry = flatStats.toJson("jump_point", longIntelligence, longQueries.size());
+            flatEntry["distance"] = "long";
+            layoutReport["results"].push_back(flatEntry);
+        }
+
+        SolverStats hierarchicalStats = runHierarchical(hierarchical, astar, longQueries, longOptimal, longIntelligence);
+        printStats(layout.name, "hierarchical", longIntelligence, hierarchicalStats);
+        nlohmann::json hierarchicalEntry = hierarchicalStats.toJson("hierarchical", longIntelligence, longQueries.size());
+        hierarchicalEntry["distance"] = "long";
+        layoutReport["results"].push_back(hierarchicalEntry);
+
+        report["layouts"].push_back(layoutReport);
+    }
+
+    std::ofstream output(outputPath);
+    if (!output) {
+        std::cerr << "无法写入基准测试结果: " << outputPath << std::endl;
+        return 1;
+    }
+    output << report.dump(2) << std::endl;
+    std::cout << "基准测试结果已写入 " << outputPath << std::endl;
+    return 0;
+}
@@ -318,38 +318,19 @@ Entity* AttackSystem::findTarget(float range) {
     Entity* closestTarget = nullptr;
     float closestDistance = range + 1;
     
-    // 检查所有僵尸
-    for (const auto& zombie : game->getZombies()) {
-        if (!zombie || zombie->getHealth() <= 0) {
+    // 检查本帧的丧尸和敌对生物
+    for (Entity* target : game->getAttackableTargets()) {
+        if (target == owner || target->getHealth() <= 0) {
             continue;
         }
         
-        float dx = zombie->getX() - owner->getX();
-        float dy = zombie->getY() - owner->getY();
+        float dx = target->getX() - owner->getX();
+        float dy = target->getY() - owner->getY();
         float distance = std::sqrt(dx * dx + dy * dy);
         
         if (distance <= range && distance < closestDistance) {
             closestDistance = distance;
-            closestTarget = zombie.get();
-        }
-    }
-    
-    // 检查其他生物
-    for (const auto& creature : game->getCreatures()) {
-        if (!creature || creature.get() == owner || creature->getHealth() <= 0) {
-            continue;
-        }
-        
-        // 检查是否是敌对阵营
-        if (creature->getFaction() == Faction::ENEMY || creature->getFaction() == Faction::HOSTILE) {
-            float dx = creature->getX() - owner->getX();
-            float dy = creature->getY() - owner->getY();
-            float distance = std::sqrt(dx * dx + dy * dy);
-            
-            if (distance <= range && distance < closestDistance) {
-                closestDistance = distance;
-                closestTarget = creature.get();
-            }
+            closestTarget = target;
         }
     }
     
@@ -365,60 +346,14 @@ std::vector<Entity*> AttackSystem::getTargetsInRange(const AttackParams& params)
     Game* game = Game::getInstance();
     if (!game) return targets;
     
-    // 检查所有僵尸
-    for (const auto& zombie : game->getZombies()) {
-        if (!zombie || zombie->getHealth() <= 0) {
-            continue;
-        }
-        
-        bool inRange = false;
-        switch (params.shape) {
-            case AttackShape::CIRCLE:
-                inRange = isTargetInCircle(zombie.get(), params.range);
-                break;
-            case AttackShape::SECTOR:
-                inRange = isTargetInSector(zombie.get(), params);
-                break;
-            case AttackShape::RECTANGLE:
-                inRange = isTargetInRectangle(zombie.get(), params);
-                break;
-            case AttackShape::LINE:
-                inRange = isTargetInLine(zombie.get(), params);
-                break;
-        }
-        
-        if (inRange) {
-            targets.push_back(zombie.get());
-        }
-    }
-    
-    // 检查其他生物
-    for (const auto& creature : game->getCreatures()) {
-        if (!creature || creature.get() == owner || creature->getHealth() <= 0) {
+    // 检查本帧的丧尸和敌对生物
+    for (Entity* target : game->getAttackableTargets()) {
+        if (target == owner || target->getHealth() <= 0) {
             continue;
         }
         
-        // 检查是否是敌对阵营
-        if (creature->getFaction() == Faction::ENEMY || creature->getFaction() == Faction::HOSTILE) {
-            bool inRange = false;
-            switch (params.shape) {
-                case AttackShape::CIRCLE:
-                    inRange = isTargetInCircle(creature.get(), params.range);
-                    break;
-                case AttackShape::SECTOR:
-                    inRange = isTargetInSector(creature.get(), params);
-                    break;
-                case AttackShape::RECTANGLE:
-                    inRange = isTargetInRectangle(creature.get(), params);
-                    break;
-                case AttackShape::LINE:
-                    inRange = isTargetInLine(creature.get(), params);
-                    break;
-            }
-            
-            if (inRange) {
-                targets.push_back(creature.get());
-            }
+        if (isTargetInShape(target, params)) {
+            targets.push_back(target);
         }
     }
     
@@ -461,68 +396,17 @@ Entity* AttackSystem::findTargetInShape(const AttackParams& params) const {
     Entity* closestTarget = nullptr;
     float closestDistance = params.range + 1;
     
-    // 检查所有僵尸
-    for (const auto& zombie : game->getZombies()) {
-        if (!zombie || zombie->getHealth() <= 0) {
+    // 检查本帧的丧尸和敌对生物
+    for (Entity* target : game->getAttackableTargets()) {
+        if (target == owner || target->getHealth() <= 0) {
             continue;
         }
         
-        bool inRange = false;
-        switch (params.shape) {
-            case AttackShape::CIRCLE:
-                inRange = isTargetInCircle(zombie.get(), params.range);
-                break;
-            case AttackShape::SECTOR:
-            case AttackShape::LARGE_SECTOR:
-                inRange = isTargetInSector(zombie.get(), params);
-                break;
-            case AttackShape::RECTANGLE:
-                inRange = isTargetInRectangle(zombie.get(), params);
-                break;
-            case AttackShape::LINE:
-                inRange = isTargetInLine(zombie.get(), params);
-                break;
-        }
-        
-        if (inRange) {
-            float distance = getDistanceToTarget(zombie.get());
+        if (isTargetInShape(target, params)) {
+            float distance = getDistanceToTarget(target);
             if (distance < closestDistance) {
                 closestDistance = distance;
-                closestTarget = zombie.get();
-            }
-        }
-    }
-    
-    // 检查其他生物
-    for (const auto& creature : game->getCreatures()) {
-        if (!creature || creature.get() == owner || creature->getHealth() <= 0) {
-            continue;
-        }
-        
-        // 检查是否是敌对阵营
-        if (creature->getFaction() == Faction::ENEMY || creature->getFaction() == Faction::HOSTILE) {
-            bool inRange = false;
-            switch (params.shape) {
-                case AttackShape::CIRCLE:
-                    inRange = isTargetInCircle(creature.get(), params.range);
-                    break;
-                case AttackShape::SECTOR:
-                    inRange = isTargetInSector(creature.get(), params);
-                    break;
-                case AttackShape::RECTANGLE:
-                    inRange = isTargetInRectangle(creature.get(), params);
-                    break;
-                case AttackShape::LINE:
-                    inRange = isTargetInLine(creature.get(), params);
-                    break;
-            }
-            
-            if (inRange) {
-                float distance = getDistanceToTarget(creature.get());
-                if (distance < closestDistance) {
-                    closestDistance = distance;
-                    closestTarget = creature.get();
-                }
+                closestTarget = target;
             }
         }
     }
@@ -530,6 +414,21 @@ Entity* AttackSystem::findTargetInShape(const AttackParams& params) const {
     return closestTarget;
 }
 
+bool AttackSystem::isTargetInShape(Entity* target, const AttackParams& params) const {
+    switch (params.shape) {
+        case AttackShape::CIRCLE:
+            return isTargetInCircle(target, params.range);
+        case AttackShape::SECTOR:
+        case AttackShape::LARGE_SECTOR:
+            return isTargetInSector(target, params);
+        case AttackShape::RECTANGLE:
+            return isTargetInRectangle(target, params);
+        case AttackShape::LINE:
+            return isTargetInLine(target, params);
+    }
+    return false;
+}
+
 bool AttackSystem::isTargetInCircle(Entity* target, float range) const {
     if (!target || !owner) return false;
     
@@ -172,6 +172,7 @@ private:
     
     // 形状检测方法
     Entity* findTargetInShape(const AttackParams& params) const;
+    bool isTargetInShape(Entity* target, const AttackParams& params) const;
     bool isTargetInCircle(Entity* target, float range) const;
     bool isTargetInSector(Entity* target, const AttackParams& params) const;
     bool isTargetInRectangle(Entity* target, const AttackParams& params) const;
@@ -1,230 +1,227 @@
 #include "Bullet.h"
 #include "Entity.h"
 #include "Constants.h"
+#include "Map.h"
+#include "SpatialHash.h"
 #include <cmath>
 #include <algorithm>
 
-// 修改 Bullet 构造函数
-Bullet::Bullet(float startX, float startY, float dx, float dy, float s, 
-    Entity* bulletOwner, int damageValue, const std::string& damageType, int penetration, float range)
-: x(startX), y(startY), prevX(startX), prevY(startY),
-  dirX(dx), dirY(dy), speed(s), active(true), 
-  owner(bulletOwner),
-  maxRange(range * GameConstants::TILE_SIZE),
-  traveledDistance(0.0f),
-  damage(bulletOwner) {
-    // 添加伤害
-    damage.addDamage(damageType, damageValue, penetration);
-    
-    // 计算子弹飞行角度
-    angle = std::atan2(dy, dx);
-}
+uint32_t BulletPool::acquireDamageProfile(Entity* owner, const std::string& type, int value, int penetration) {
+    // 同一所有者、同一参数的子弹共享伤害档案（档案数量通常只有个位数，线性查找即可）
+    uint32_t freeIndex = static_cast<uint32_t>(damageProfiles.size());
+    for (uint32_t i = 0; i < damageProfiles.size(); ++i) {
+        DamageProfile& profile = damageProfiles[i];
+        if (profile.refCount == 0) {
+            if (freeIndex == damageProfiles.size()) {
+                freeIndex = i;
+            }
+            continue;
+        }
+        if (profile.owner == owner && profile.value == value &&
+            profile.penetration == penetration && profile.type == type) {
+            profile.refCount++;
+            return i;
+        }
+    }
 
-// 添加伤害方法（字符串类型）
-void Bullet::addDamage(const std::string& type, int amount, int penetration) {
-    damage.addDamage(type, amount, penetration);
-}
+    // 没有匹配的档案，复用空闲档案或新建
+    if (freeIndex == damageProfiles.size()) {
+        damageProfiles.emplace_back();
+    }
 
-// 添加伤害方法（枚举类型）
-void Bullet::addDamage(DamageType type, int amount, int penetration) {
-    damage.addDamage(type, amount, penetration);
+    DamageProfile& profile = damageProfiles[freeIndex];
+    profile.damage.clear();
+    profile.damage.setSource(owner);
+    profile.damage.addDamage(type, value, penetration);
+    profile.owner = owner;
+    profile.type = type;
+    profile.value = value;
+    profile.penetration = penetration;
+    profile.refCount = 1;
+    return freeIndex;
 }
 
-void Bullet::update(float deltaTime) {
-    if (!active) return;
-    
-    // 保存上一帧位置
-    prevX = x;
-    prevY = y;
-    
-    // 更新位置
-    float moveX = dirX * speed * deltaTime * 60;
-    float moveY = dirY * speed * deltaTime * 60;
-    x += moveX;
-    y += moveY;
-    
-    // 计算本次移动距离并累加到总飞行距离
-    float distanceMoved = std::sqrt(moveX * moveX + moveY * moveY);
-    traveledDistance += distanceMoved;
-    
-    // 检查是否超过最大射程
-    if (traveledDistance >= maxRange) {
-        active = false;
-        return;
+void BulletPool::releaseDamageProfile(uint32_t index) {
+    if (index < damageProfiles.size() && damageProfiles[index].refCount > 0) {
+        damageProfiles[index].refCount--;
     }
 }
 
-void Bullet::render(SDL_Renderer* renderer, int cameraX, int cameraY) {
-    if (!active) return;
-    
-    // 计算屏幕坐标
-    float screenX = x - cameraX;
-    float screenY = y - cameraY;
-    
-    // 设置线段宽度为3像素
-    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // 黄色子弹
-    
-    // 绘制一条较短的线段（长度为50像素）
-    float endX = screenX + dirX * 50;
-    float endY = screenY + dirY * 50;
-    
-    // 绘制主线段
-    SDL_RenderLine(renderer, 
-                  static_cast<int>(screenX), static_cast<int>(screenY),
-                  static_cast<int>(endX), static_cast<int>(endY));
-    
-    // 绘制额外的线段来增加宽度
-    SDL_RenderLine(renderer, 
-                  static_cast<int>(screenX - 1), static_cast<int>(screenY - 1),
-                  static_cast<int>(endX - 1), static_cast<int>(endY - 1));
-    SDL_RenderLine(renderer, 
-                  static_cast<int>(screenX + 1), static_cast<int>(screenY + 1),
-                  static_cast<int>(endX + 1), static_cast<int>(endY + 1));
-}
-
-bool Bullet::checkLineCircleCollision(float x1, float y1, float x2, float y2,
-                                    float cx, float cy, float r, float& outT) const {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    float fx = x1 - cx;
-    float fy = y1 - cy;
-
-    float a = dx*dx + dy*dy;
-    float b = 2 * (fx*dx + fy*dy);
-    float c = (fx*fx + fy*fy) - r*r;
-
-    float discriminant = b*b - 4*a*c;
-    if (discriminant < 0) return false;
-
-    discriminant = std::sqrt(discriminant);
-    float t1 = (-b - discriminant) / (2*a);
-    float t2 = (-b + discriminant) / (2*a);
-
-    bool hit = false;
-    outT = 1.1f; // 超出线段范围
-    if (t1 >= 0 && t1 <= 1) { outT = t1; hit = true; }
-    if (t2 >= 0 && t2 <= 1 && t2 < outT) { outT = t2; hit = true; }
-    return hit;
+void BulletPool::spawn(float startX, float startY, float dx, float dy, float s,
+                       Entity* owner, int damageValue, const std::string& damageType,
+                       int penetration, float range) {
+    posX.push_back(startX);
+    posY.push_back(startY);
+    prevX.push_back(startX);
+    prevY.push_back(startY);
+    dirX.push_back(dx);
+    dirY.push_back(dy);
+    speed.push_back(s);
+    maxRange.push_back(range * GameConstants::TILE_SIZE);
+    traveledDistance.push_back(0.0f);
+    owners.push_back(owner);
+    damageIndex.push_back(acquireDamageProfile(owner, damageType, damageValue, penetration));
 }
 
-bool Bullet::checkLineRectCollision(float x1, float y1, float x2, float y2,
-                                  float rx, float ry, float rw, float rh, float& outT) const {
-    float tmin = 0.0f, tmax = 1.0f;
-    float dx = x2 - x1, dy = y2 - y1;
-
-    // X轴
-    if (std::abs(dx) < 1e-8) {
-        if (x1 < rx || x1 > rx + rw) return false;
-    } else {
-        float ood = 1.0f / dx;
-        float t1 = (rx - x1) * ood;
-        float t2 = (rx + rw - x1) * ood;
-        if (t1 > t2) std::swap(t1, t2);
-        tmin = std::max(tmin, t1);
-        tmax = std::min(tmax, t2);
-        if (tmin > tmax) return false;
-    }
-
-    // Y轴
-    if (std::abs(dy) < 1e-8) {
-        if (y1 < ry || y1 > ry + rh) return false;
-    } else {
-        float ood = 1.0f / dy;
-        float t1 = (ry - y1) * ood;
-        float t2 = (ry + rh - y1) * ood;
-        if (t1 > t2) std::swap(t1, t2);
-        tmin = std::max(tmin, t1);
-        tmax = std::min(tmax, t2);
-        if (tmin > tmax) return false;
-    }
-
-    if (tmin >= 0.0f && tmin <= 1.0f) {
-        outT = tmin;
-        return true;
+void BulletPool::removeAt(size_t index) {
+    releaseDamageProfile(damageIndex[index]);
+
+    // 用最后一颗子弹覆盖被删除的子弹
+    size_t last = posX.size() - 1;
+    if (index != last) {
+        posX[index] = posX[last];
+        posY[index] = posY[last];
+        prevX[index] = prevX[last];
+        prevY[index] = prevY[last];
+        dirX[index] = dirX[last];
+        dirY[index] = dirY[last];
+        speed[index] = speed[last];
+        maxRange[index] = maxRange[last];
+        traveledDistance[index] = traveledDistance[last];
+        owners[index] = owners[last];
+        damageIndex[index] = damageIndex[last];
     }
-    return false;
-}
 
-void Bullet::handleCollision(float collisionT) {
-    // 将子弹位置调整到碰撞点
-    x = prevX + (x - prevX) * collisionT;
-    y = prevY + (y - prevY) * collisionT;
-    active = false;
+    posX.pop_back();
+    posY.pop_back();
+    prevX.pop_back();
+    prevY.pop_back();
+    dirX.pop_back();
+    dirY.pop_back();
+    speed.pop_back();
+    maxRange.pop_back();
+    traveledDistance.pop_back();
+    owners.pop_back();
+    damageIndex.pop_back();
 }
 
-bool Bullet::checkObstacleCollisions(const std::vector<Collider>& obstacles) {
-    if (!active) return false;
-    
-    float minT = 1.1f;
-    bool hasCollision = false;
-    
-    for (const auto& obstacle : obstacles) {
-        float t;
-        bool hit = false;
-        
-        if (obstacle.getType() == ColliderType::CIRCLE) {
-            hit = checkLineCircleCollision(prevX, prevY, x, y,
-                                         obstacle.getCircleX(), obstacle.getCircleY(),
-                                         obstacle.getRadius(), t);
-        } else {
-            const SDL_FRect& box = obstacle.getBoxCollider();
-            hit = checkLineRectCollision(prevX, prevY, x, y,
-                                       box.x, box.y, box.w, box.h, t);
+void BulletPool::update(float deltaTime, const Map* map, const SpatialHash* entityHash) {
+    size_t i = 0;
+    while (i < posX.size()) {
+        // 保存上一帧位置
+        prevX[i] = posX[i];
+        prevY[i] = posY[i];
+
+        // 更新位置
+        float moveX = dirX[i] * speed[i] * deltaTime * 60;
+        float moveY = dirY[i] * speed[i] * deltaTime * 60;
+        posX[i] += moveX;
+        posY[i] += moveY;
+
+        // 累加飞行距离，超过最大射程的子弹直接移除
+        traveledDistance[i] += std::sqrt(moveX * moveX + moveY * moveY);
+        if (traveledDistance[i] >= maxRange[i]) {
+            removeAt(i);
+            continue; // 交换进来的子弹尚未更新，停留在当前下标
         }
-        
-        if (hit && t < minT) {
-            minT = t;
-            hasCollision = true;
+
+        if (sweep(i, map, entityHash)) {
+            removeAt(i);
+            continue;
         }
+
+        ++i;
     }
-    
-    if (hasCollision) {
-        handleCollision(minT);
-        return true;
-    }
-    return false;
 }
 
-bool Bullet::checkEntityCollisions(const std::vector<Entity*>& entities) {
-    if (!active) return false;
-    
-    float minT = 1.1f;
+bool BulletPool::sweep(size_t index, const Map* map, const SpatialHash* entityHash) {
+    if (!map) return false;
+
+    float x1 = prevX[index], y1 = prevY[index];
+    float x2 = posX[index], y2 = posY[index];
+
+    // 遍历本帧移动线段经过的方块，收集实体候选并找到最近的地形命中
+    entityBuffer.clear();
+    float terrainT;
+    bool hitTerrain = map->sweepSegment(x1, y1, x2, y2, entityHash, entityBuffer, terrainT);
+
+    // 位于地形命中点之前的实体优先被击中
+    Entity* owner = owners[index];
+    float minT = hitTerrain ? terrainT : 1.1f;
     Entity* hitEntity = nullptr;
-    
-    for (auto* entity : entities) {
+
+    for (Entity* entity : entityBuffer) {
         // 不检测与自己的碰撞
         if (entity == owner) continue;
-        
+
         // 不检测与同阵营实体的碰撞（除非是中立阵营）
-        if (owner && entity->getFaction() == owner->getFaction() && 
+        if (owner && entity->getFaction() == owner->getFaction() &&
             owner->getFaction() != Faction::NEUTRAL) {
             continue;
         }
-        
-        const Collider& entityCollider = entity->getCollider();
+
         float t;
-        bool hit = false;
-        
-        if (entityCollider.getType() == ColliderType::CIRCLE) {
-            hit = checkLineCircleCollision(prevX, prevY, x, y,
-                                         entityCollider.getCircleX(), entityCollider.getCircleY(),
-                                         entityCollider.getRadius(), t);
-        } else {
-            const SDL_FRect& box = entityCollider.getBoxCollider();
-            hit = checkLineRectCollision(prevX, prevY, x, y,
-                                       box.x, box.y, box.w, box.h, t);
-        }
-        
-        if (hit && t < minT) {
+        if (entity->getCollider().intersectsSegment(x1, y1, x2, y2, t) && t < minT) {
             minT = t;
             hitEntity = entity;
         }
     }
-    
+
+    if (!hitEntity && !hitTerrain) {
+        return false;
+    }
+
+    // 将子弹位置调整到碰撞点
+    posX[index] = x1 + (x2 - x1) * minT;
+    posY[index] = y1 + (y2 - y1) * minT;
+
     if (hitEntity) {
-        handleCollision(minT);
-        hitEntity->takeDamage(damage);
-        return true;
+        hitEntity->takeDamage(damageProfiles[damageIndex[index]].damage);
     }
-    return false;
-}
\ No newline at end of file
+    return true;
+}
+
+void BulletPool::renderBullet(SDL_Renderer* renderer, size_t index, int cameraX, int cameraY) const {
+    // 计算屏幕坐标
+    float screenX = posX[index] - cameraX;
+    float screenY = posY[index] - cameraY;
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // 黄色子弹
+
+    // 绘制一条较短的线段（长度为50像素）
+    float endX = screenX + dirX[index] * 50;
+    float endY = screenY + dirY[index] * 50;
+
+    // 绘制主线段
+    SDL_RenderLine(renderer,
+                  static_cast<int>(screenX), static_cast<int>(screenY),
+                  static_cast<int>(endX), static_cast<int>(endY));
+
+    // 绘制额外的线段来增加宽度
+    SDL_RenderLine(renderer,
+                  static_cast<int>(screenX - 1), static_cast<int>(screenY - 1),
+                  static_cast<int>(endX - 1), static_cast<int>(endY - 1));
+    SDL_RenderLine(renderer,
+                  static_cast<int>(screenX + 1), static_cast<int>(screenY + 1),
+                  static_cast<int>(endX + 1), static_cast<int>(endY + 1));
+}
+
+void BulletPool::reserve(size_t capacity) {
+    posX.reserve(capacity);
+    posY.reserve(capacity);
+    prevX.reserve(capacity);
+    prevY.reserve(capacity);
+    dirX.reserve(capacity);
+    dirY.reserve(capacity);
+    speed.reserve(capacity);
+    maxRange.reserve(capacity);
+    traveledDistance.reserve(capacity);
+    owners.reserve(capacity);
+    damageIndex.reserve(capacity);
+}
+
+void BulletPool::clear() {
+    // 只清空内容，保留容量
+    posX.clear();
+    posY.clear();
+    prevX.clear();
+    prevY.clear();
+    dirX.clear();
+    dirY.clear();
+    speed.clear();
+    maxRange.clear();
+    traveledDistance.clear();
+    owners.clear();
+    damageIndex.clear();
+    damageProfiles.clear();
+}
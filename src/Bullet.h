@@ -6,57 +6,89 @@
 #include "Damage.h"
 #include <SDL3/SDL.h>
 #include <vector>
+#include <string>
+#include <cstdint>
 
 class Entity; // 前向声明
+class Map;
+class SpatialHash;
 
-class Bullet {
+// 子弹池：以结构数组（SoA）存储所有飞行中的子弹
+// - 位置/方向/射程等按列连续存放，逐帧更新时顺序访问
+// - 移除子弹使用交换删除（swap-and-pop），不移动其他子弹
+// - 伤害信息按伤害档案共享，子弹只保存档案索引
+// 预热后（容量达到峰值子弹数）发射子弹不再分配内存
+class BulletPool {
 private:
-    float x, y;           // 当前位置
-    float prevX, prevY;   // 上一帧位置
-    float dirX, dirY;     // 方向
-    float speed;          // 速度
-    bool active;          // 是否活跃
-    Entity* owner;        // 子弹所有者
-    float angle;          // 子弹飞行角度（弧度）
-    float maxRange;       // 最大射程
-    float traveledDistance; // 已飞行距离
-    Damage damage;        // 子弹造成的伤害
-
-    // 线段检测相关方法
-    bool checkLineCircleCollision(float x1, float y1, float x2, float y2,
-                                float cx, float cy, float r, float& outT) const;
-    bool checkLineRectCollision(float x1, float y1, float x2, float y2,
-                              float rx, float ry, float rw, float rh, float& outT) const;
-    void handleCollision(float collisionT);
+    // 伤害档案：同一所有者以相同参数发射的子弹共享一份Damage
+    struct DamageProfile {
+        Damage damage;          // 共享的伤害数据
+        Entity* owner;          // 伤害来源
+        std::string type;       // 伤害类型
+        int value;              // 伤害值
+        int penetration;        // 穿透值
+        int refCount;           // 引用该档案的子弹数量，为0时档案可复用
+
+        DamageProfile() : owner(nullptr), value(0), penetration(-1), refCount(0) {}
+    };
+
+    // 子弹数据列（下标相同的元素属于同一颗子弹）
+    std::vector<float> posX, posY;          // 当前位置
+    std::vector<float> prevX, prevY;        // 上一帧位置
+    std::vector<float> dirX, dirY;          // 飞行方向
+    std::vector<float> speed;               // 速度
+    std::vector<float> maxRange;            // 最大射程（像素）
+    std::vector<float> traveledDistance;    // 已飞行距离
+    std::vector<Entity*> owners;            // 子弹所有者
+    std::vector<uint32_t> damageIndex;      // 伤害档案索引
+
+    std::vector<DamageProfile> damageProfiles; // 伤害档案表
+
+    // 获取或创建伤害档案，返回档案索引
+    uint32_t acquireDamageProfile(Entity* owner, const std::string& type, int value, int penetration);
+    void releaseDamageProfile(uint32_t index);
+
+    // 交换删除第index颗子弹
+    void removeAt(size_t index);
+
+    // 扫掠第index颗子弹本帧的移动线段，命中时返回true
+    bool sweep(size_t index, const Map* map, const SpatialHash* entityHash);
+
+    std::vector<Entity*> entityBuffer;      // 实体候选复用缓冲区
 
 public:
-    Bullet(float startX, float startY, float dx, float dy, float s, 
-           Entity* bulletOwner, int damageValue, const std::string& damageType = "shooting", 
-           int penetration = -1, float range = 1000.0f);
-    ~Bullet() = default;
-    
-    void update(float deltaTime = 1.0f / 60.0f);
-    void render(SDL_Renderer* renderer, int cameraX, int cameraY);
-    
-    // 检查与障碍物的碰撞
-    bool checkObstacleCollisions(const std::vector<Collider>& obstacles);
-    bool checkEntityCollisions(const std::vector<Entity*>& entities);
-    
+    BulletPool() = default;
+
+    BulletPool(const BulletPool&) = delete;
+    BulletPool& operator=(const BulletPool&) = delete;
+
+    // 发射一颗子弹，range以格为单位
+    void spawn(float startX, float startY, float dx, float dy, float s,
+               Entity* owner, int damageValue, const std::string& damageType = "shooting",
+               int penetration = -1, float range = 1000.0f);
+
+    // 更新所有子弹：移动、扫掠碰撞检测，并移除命中或超出射程的子弹
+    void update(float deltaTime, const Map* map, const SpatialHash* entityHash);
+
+    // 渲染第index颗子弹
+    void renderBullet(SDL_Renderer* renderer, size_t index, int cameraX, int cameraY) const;
+
+    // 预留容量，避免战斗开始时的扩容
+    void reserve(size_t capacity);
+
+    // 清空所有子弹和伤害档案
+    void clear();
+
     // 获取器
-    float getX() const { return x; }
-    float getY() const { return y; }
-    float getDirX() const { return dirX; }
-    float getDirY() const { return dirY; }
-    bool isActive() const { return active; }
-    const Damage& getDamage() const { return damage; }
-    Entity* getOwner() const { return owner; }
-    
-    // 设置器
-    void setActive(bool state) { active = state; }
-    
-    // 添加伤害
-    void addDamage(const std::string& type, int amount, int penetration = -1);
-    void addDamage(DamageType type, int amount, int penetration = -1);
+    size_t size() const { return posX.size(); }
+    bool empty() const { return posX.empty(); }
+    float getX(size_t index) const { return posX[index]; }
+    float getY(size_t index) const { return posY[index]; }
+    float getDirX(size_t index) const { return dirX[index]; }
+    float getDirY(size_t index) const { return dirY[index]; }
+    Entity* getOwner(size_t index) const { return owners[index]; }
+    const Damage& getDamage(size_t index) const { return damageProfiles[damageIndex[index]].damage; }
+    size_t getDamageProfileCount() const { return damageProfiles.size(); }
 };
 
-#endif // BULLET_H
\ No newline at end of file
+#endif // BULLET_H
@@ -0,0 +1,215 @@
+#include "ChunkGenerator.h"
+#include "Grid.h"
+#include "Tile.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // 各噪声层和随机数流的盐值，保证不同用途的随机数互不相关
+    constexpr uint64_t SALT_ROUGH = 1;
+    constexpr uint64_t SALT_RUINS = 2;
+    constexpr uint64_t SALT_RUBBLE = 3;
+    constexpr uint64_t SALT_LAYOUT = 4;
+
+    uint64_t mix64(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // splitmix64：网格内布局使用的随机数序列
+    uint64_t nextRandom(uint64_t& state) {
+        state += 0x9e3779b97f4a7c15ull;
+        return mix64(state);
+    }
+
+    int randomRange(uint64_t& state, int minValue, int maxValue) {
+        return minValue + static_cast<int>(nextRandom(state) % static_cast<uint64_t>(maxValue - minValue + 1));
+    }
+
+    float toUnitFloat(uint64_t value) {
+        return static_cast<float>(value >> 40) * (1.0f / 16777216.0f);
+    }
+}
+
+ChunkGenerator::ChunkGenerator(uint64_t worldSeed)
+    : seed(worldSeed),
+      grassType(Tile::internType("Grassland", "assets/tiles/grassland.bmp", false, true, false)),
+      roughType(Tile::internType("Rough", "assets/tiles/grassland2.bmp", false, true, false)),
+      wallType(Tile::internType("Brick", "assets/tiles/brick.bmp", true, true, true)) {
+}
+
+uint64_t ChunkGenerator::hash(int x, int y, uint64_t salt) const {
+    uint64_t key = seed ^ (salt * 0x9e3779b97f4a7c15ull);
+    key ^= static_cast<uint64_t>(static_cast<uint32_t>(x)) * 0xbf58476d1ce4e5b9ull;
+    key ^= static_cast<uint64_t>(static_cast<uint32_t>(y)) * 0x94d049bb133111ebull;
+    return mix64(key);
+}
+
+float ChunkGenerator::valueNoise(float x, float y, uint64_t salt) const {
+    float floorX = std::floor(x);
+    float floorY = std::floor(y);
+    int cellX = static_cast<int>(floorX);
+    int cellY = static_cast<int>(floorY);
+    float tx = x - floorX;
+    float ty = y - floorY;
+    tx = tx * tx * (3.0f - 2.0f * tx);
+    ty = ty * ty * (3.0f - 2.0f * ty);
+
+    float v00 = toUnitFloat(hash(cellX, cellY, salt));
+    float v10 = toUnitFloat(hash(cellX + 1, cellY, salt));
+    float v01 = toUnitFloat(hash(cellX, cellY + 1, salt));
+    float v11 = toUnitFloat(hash(cellX + 1, cellY + 1, salt));
+    float top = v00 + (v10 - v00) * tx;
+    float bottom = v01 + (v11 - v01) * tx;
+    return top + (bottom - top) * ty;
+}
+
+float ChunkGenerator::fractalNoise(float x, float y, uint64_t salt) const {
+    return valueNoise(x, y, salt) * (2.0f / 3.0f) + valueNoise(x * 2.0f, y * 2.0f, salt + 100) * (1.0f / 3.0f);
+}
+
+bool ChunkGenerator::stampBuilding(std::vector<uint8_t>& cells, int gridSize, uint64_t& rngState) const {
+    int maxSize = std::min(MAX_BUILDING_SIZE, gridSize - 2);
+    if (maxSize < MIN_BUILDING_SIZE) return false;
+
+    int width = randomRange(rngState, MIN_BUILDING_SIZE, maxSize);
+    int height = randomRange(rngState, MIN_BUILDING_SIZE, maxSize);
+    // 与网格边界至少留一格，建筑不跨网格，网格之间总能通行
+    int left = randomRange(rngState, 1, gridSize - 1 - width);
+    int top = randomRange(rngState, 1, gridSize - 1 - height);
+    int right = left + width - 1;
+    int bottom = top + height - 1;
+
+    // 与已有建筑之间至少隔一格
+    for (int y = top - 1; y <= bottom + 1; ++y) {
+        for (int x = left - 1; x <= right + 1; ++x) {
+            uint8_t cell = cells[y * gridSize + x];
+            if (cell == CELL_WALL || cell == CELL_FLOOR) return false;
+        }
+    }
+
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            bool edge = x == left || x == right || y == top || y == bottom;
+            cells[y * gridSize + x] = edge ? CELL_WALL : CELL_FLOOR;
+        }
+    }
+
+    // 开门：门洞和门外一格都是空地（门外不生成瓦砾）
+    auto openDoor = [&cells, gridSize](int x, int y, int outsideX, int outsideY) {
+        cells[y * gridSize + x] = CELL_FLOOR;
+        cells[outsideY * gridSize + outsideX] = CELL_FLOOR;
+    };
+
+    // 较大的建筑沿长边方向加一道隔墙分成两个房间，隔墙上开门
+    bool splitVertical = width >= height;
+    if (std::max(width, height) >= ROOM_SPLIT_SIZE) {
+        if (splitVertical) {
+            int wallX = randomRange(rngState, left + 3, right - 3);
+            for (int y = top + 1; y < bottom; ++y) cells[y * gridSize + wallX] = CELL_WALL;
+            cells[randomRange(rngState, top + 1, bottom - 1) * gridSize + wallX] = CELL_FLOOR;
+        } else {
+            int wallY = randomRange(rngState, top + 3, bottom - 3);
+            for (int x = left + 1; x < right; ++x) cells[wallY * gridSize + x] = CELL_WALL;
+            cells[wallY * gridSize + randomRange(rngState, left + 1, right - 1)] = CELL_FLOOR;
+        }
+    }
+
+    // 门开在与隔墙平行的两侧（不会正对隔墙与外墙的交点），第一扇门必开，第二扇一半概率
+    for (int door = 0; door < 2; ++door) {
+        if (door == 1 && (nextRandom(rngState) & 1)) break;
+        bool firstSide = (door == 0);
+        if (splitVertical) {
+            int y = randomRange(rngState, top + 1, bottom - 1);
+            if (firstSide) openDoor(left, y, left - 1, y);
+            else openDoor(right, y, right + 1, y);
+        } else {
+            int x = randomRange(rngState, left + 1, right - 1);
+            if (firstSide) openDoor(x, top, x, top - 1);
+            else openDoor(x, bottom, x, bottom + 1);
+        }
+    }
+    return true;
+}
+
+void ChunkGenerator::generateCells(int chunkX, int chunkY, int gridSize, std::vector<uint8_t>& cells) const {
+    cells.assign(gridSize * gridSize, CELL_GRASS);
+    int originX = chunkX * gridSize;
+    int originY = chunkY * gridSize;
+
+    // 地表：按全局方块坐标取噪声，崎岖地形跨网格连续
+    for (int y = 0; y < gridSize; ++y) {
+        for (int x = 0; x < gridSize; ++x) {
+            float noise = fractalNoise((originX + x) * ROUGH_SCALE, (originY + y) * ROUGH_SCALE, SALT_ROUGH);
+            if (noise > ROUGH_THRESHOLD) {
+                cells[y * gridSize + x] = CELL_ROUGH;
+            }
+        }
+    }
+
+    // 出生点周围保持空旷
+    if (std::abs(chunkX) <= 1 && std::abs(chunkY) <= 1) {
+        return;
+    }
+
+    // 废墟：网格级噪声越高建筑越多
+    float ruins = valueNoise(chunkX * RUINS_SCALE, chunkY * RUINS_SCALE, SALT_RUINS);
+    int buildingCount = ruins < 0.45f ? 0 : (ruins < 0.7f ? 1 : 2);
+    uint64_t rngState = hash(chunkX, chunkY, SALT_LAYOUT);
+    for (int building = 0; building < buildingCount; ++building) {
+        for (int attempt = 0; attempt < BUILDING_ATTEMPTS; ++attempt) {
+            if (stampBuilding(cells, gridSize, rngState)) break;
+        }
+    }
+
+    // 瓦砾：只出现在崎岖地形中，且周围8格没有墙，不会与墙围出封闭的空地
+    auto touchesWall = [&cells, gridSize](int x, int y) {
+        for (int ny = std::max(0, y - 1); ny <= std::min(gridSize - 1, y + 1); ++ny) {
+            for (int nx = std::max(0, x - 1); nx <= std::min(gridSize - 1, x + 1); ++nx) {
+                if (cells[ny * gridSize + nx] == CELL_WALL) return true;
+            }
+        }
+        return false;
+    };
+    for (int y = 0; y < gridSize; ++y) {
+        for (int x = 0; x < gridSize; ++x) {
+            uint8_t& cell = cells[y * gridSize + x];
+            if (cell == CELL_ROUGH && toUnitFloat(hash(originX + x, originY + y, SALT_RUBBLE)) < RUBBLE_CHANCE &&
+                !touchesWall(x, y)) {
+                cell = CELL_WALL;
+            }
+        }
+    }
+}
+
+std::unique_ptr<Grid> ChunkGenerator::generate(int chunkX, int chunkY) const {
+    const int gridSize = GameConstants::MAP_GRID_SIZE;
+    const int tileSize = GameConstants::TILE_SIZE;
+
+    std::vector<uint8_t> cells;
+    generateCells(chunkX, chunkY, gridSize, cells);
+
+    auto grid = std::make_unique<Grid>("GeneratedGrid", chunkX * gridSize * tileSize, chunkY * gridSize * tileSize,
+                                       gridSize, tileSize);
+    for (int y = 0; y < gridSize; ++y) {
+        for (int x = 0; x < gridSize; ++x) {
+            switch (cells[y * gridSize + x]) {
+                case CELL_ROUGH:
+                    grid->addTile(Tile(roughType, 0, 0, tileSize, ROUGH_MOVE_COST), x, y);
+                    break;
+                case CELL_WALL:
+                    grid->addTile(Tile(wallType, 0, 0, tileSize), x, y);
+                    break;
+                default:
+                    grid->addTile(Tile(grassType, 0, 0, tileSize), x, y);
+                    break;
+            }
+        }
+    }
+    return grid;
+}
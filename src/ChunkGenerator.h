@@ -0,0 +1,67 @@
+#pragma once
+#ifndef CHUNK_GENERATOR_H
+#define CHUNK_GENERATOR_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+class Grid;
+struct TileType;
+
+// 确定性的程序化网格生成器
+// 生成结果只取决于(worldSeed, chunkX, chunkY)：同一种子下未修改过的网格可以随时丢弃并重新生成
+// - 地表：低频值噪声决定崎岖地形（高耗时）的分布，跨网格连续
+// - 废墟：网格级噪声决定建筑数量，建筑为砖墙围成的矩形，带门洞，较大的建筑用隔墙分成房间
+// - 瓦砾：崎岖地形中零星的单格砖块（不与其他墙相邻）
+// 出生点周围的3x3网格不放置建筑和瓦砾
+// generate不修改成员，可以在多个加载线程中同时调用
+class ChunkGenerator {
+public:
+    enum Cell : uint8_t {
+        CELL_GRASS,     // 草地
+        CELL_ROUGH,     // 崎岖地形（可通行，高耗时）
+        CELL_WALL,      // 砖墙（不可通行）
+        CELL_FLOOR      // 建筑内部（草地，不生成崎岖地形和瓦砾）
+    };
+
+    static constexpr float ROUGH_MOVE_COST = 250.0f;   // 崎岖地形的移动耗时
+    static constexpr float ROUGH_THRESHOLD = 0.62f;    // 地表噪声超过该值为崎岖地形
+    static constexpr float ROUGH_SCALE = 1.0f / 10.0f; // 地表噪声频率（每方块）
+    static constexpr float RUINS_SCALE = 1.0f / 4.0f;  // 废墟噪声频率（每网格）
+    static constexpr float RUBBLE_CHANCE = 0.04f;      // 崎岖地形中出现瓦砾的概率
+    static constexpr int MIN_BUILDING_SIZE = 6;        // 建筑边长范围（方块数，含墙）
+    static constexpr int MAX_BUILDING_SIZE = 11;
+    static constexpr int ROOM_SPLIT_SIZE = 8;          // 边长达到该值的建筑加一道隔墙
+    static constexpr int BUILDING_ATTEMPTS = 6;        // 每个建筑的放置尝试次数
+
+    explicit ChunkGenerator(uint64_t worldSeed);
+
+    // 生成网格(chunkX, chunkY)
+    std::unique_ptr<Grid> generate(int chunkX, int chunkY) const;
+
+    // 只生成格子类型（按 y * gridSize + x 排列），不创建方块
+    void generateCells(int chunkX, int chunkY, int gridSize, std::vector<uint8_t>& cells) const;
+
+    uint64_t getSeed() const { return seed; }
+
+private:
+    uint64_t seed;
+    TileType* grassType;
+    TileType* roughType;
+    TileType* wallType;
+
+    // (seed, x, y, salt)的64位哈希
+    uint64_t hash(int x, int y, uint64_t salt) const;
+
+    // 值噪声：整数格点上的随机值双线性插值（平滑插值），结果在[0, 1)
+    float valueNoise(float x, float y, uint64_t salt) const;
+
+    // 两个倍频叠加的值噪声，结果在[0, 1)
+    float fractalNoise(float x, float y, uint64_t salt) const;
+
+    // 在cells中放置建筑（失败时不修改cells）
+    bool stampBuilding(std::vector<uint8_t>& cells, int gridSize, uint64_t& rngState) const;
+};
+
+#endif // CHUNK_GENERATOR_H
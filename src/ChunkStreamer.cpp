@@ -0,0 +1,110 @@
+#include "ChunkStreamer.h"
+#include "Grid.h"
+#include <algorithm>
+
+ChunkStreamer::ChunkStreamer(Loader chunkLoader, size_t workerCount)
+    : loader(std::move(chunkLoader)), stopping(false) {
+    if (workerCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 4 ? 2 : 1;
+    }
+    workerCount = std::min(workerCount, MAX_WORKERS);
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ChunkStreamer::workerLoop, this);
+    }
+}
+
+ChunkStreamer::~ChunkStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ChunkStreamer::request(const GridCoord& coord, int priority) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = trackedChunks.find(coord);
+        if (it != trackedChunks.end()) {
+            // 已提交：玩家移动后同一网格的圈数会变化，待加载的按新优先级排队
+            it->second = priority;
+            for (PendingChunk& pending : pendingChunks) {
+                if (pending.coord == coord) {
+                    pending.priority = priority;
+                    break;
+                }
+            }
+            return;
+        }
+        trackedChunks.emplace(coord, priority);
+        pendingChunks.push_back(PendingChunk{coord, priority});
+    }
+    workAvailable.notify_one();
+}
+
+void ChunkStreamer::cancelIf(const std::function<bool(const GridCoord&)>& shouldCancel) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingChunks.erase(std::remove_if(pendingChunks.begin(), pendingChunks.end(),
+        [this, &shouldCancel](const PendingChunk& pending) {
+            if (!shouldCancel(pending.coord)) return false;
+            trackedChunks.erase(pending.coord);
+            return true;
+        }), pendingChunks.end());
+}
+
+void ChunkStreamer::collect(std::vector<CompletedChunk>& out, size_t maxCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (completedChunks.empty() || maxCount == 0) return;
+
+    // 超出预算时先取回离玩家最近的网格，其余留到下一帧
+    if (completedChunks.size() > maxCount) {
+        auto priorityOf = [this](const CompletedChunk& chunk) {
+            auto it = trackedChunks.find(chunk.coord);
+            return it != trackedChunks.end() ? it->second : 0;
+        };
+        std::partial_sort(completedChunks.begin(), completedChunks.begin() + maxCount, completedChunks.end(),
+                          [&priorityOf](const CompletedChunk& a, const CompletedChunk& b) {
+                              return priorityOf(a) < priorityOf(b);
+                          });
+    }
+
+    size_t count = std::min(maxCount, completedChunks.size());
+    for (size_t i = 0; i < count; ++i) {
+        trackedChunks.erase(completedChunks[i].coord);
+        out.push_back(std::move(completedChunks[i]));
+    }
+    completedChunks.erase(completedChunks.begin(), completedChunks.begin() + count);
+}
+
+void ChunkStreamer::workerLoop() {
+    while (true) {
+        GridCoord coord;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this] { return stopping || !pendingChunks.empty(); });
+            if (stopping) return;
+
+            // 每次取优先级最高的网格，玩家移动后新的内圈网格可以插队
+            auto best = std::min_element(pendingChunks.begin(), pendingChunks.end(),
+                [](const PendingChunk& a, const PendingChunk& b) { return a.priority < b.priority; });
+            coord = best->coord;
+            *best = pendingChunks.back();
+            pendingChunks.pop_back();
+        }
+
+        std::unique_ptr<Grid> grid = loader(coord.x, coord.y);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        // 加载失败时不留下记录，玩家下次跨越网格时会重新提交
+        if (grid) {
+            completedChunks.push_back(CompletedChunk{coord, std::move(grid)});
+        } else {
+            trackedChunks.erase(coord);
+        }
+    }
+}
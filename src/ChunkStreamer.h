@@ -0,0 +1,72 @@
+#pragma once
+#ifndef CHUNK_STREAMER_H
+#define CHUNK_STREAMER_H
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Map.h"
+
+class Grid;
+
+// 后台网格流式加载
+// 主线程按玩家位置提交需要的网格坐标（附带优先级：离玩家所在网格的圈数），
+// 加载线程按优先级从文件读取或生成网格，只构建CPU侧的方块数据；
+// 完成的网格由主线程取回后绑定纹理并加入地图
+// - 取消：玩家离开后不再需要的网格从待加载列表中撤销，已在加载中的结果由主线程丢弃
+// - 去重：同一坐标在待加载、加载中或已完成未取回时不会重复提交
+class ChunkStreamer {
+public:
+    // 加载线程调用的网格构建函数，必须线程安全（返回空表示失败）
+    using Loader = std::function<std::unique_ptr<Grid>(int gridX, int gridY)>;
+
+    struct CompletedChunk {
+        GridCoord coord;
+        std::unique_ptr<Grid> grid;
+    };
+
+private:
+    struct PendingChunk {
+        GridCoord coord;
+        int priority;    // 越小越优先（内圈3x3为0和1）
+    };
+
+    Loader loader;
+
+    // 主线程与加载线程共享，由mutex保护
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::vector<PendingChunk> pendingChunks;              // 待加载的网格（数量不超过加载范围，线性选取即可）
+    std::unordered_map<GridCoord, int> trackedChunks;     // 已提交且尚未取回的网格 -> 优先级
+    std::vector<CompletedChunk> completedChunks;
+    bool stopping;
+
+    std::vector<std::thread> workers;
+
+    static constexpr size_t MAX_WORKERS = 2; // 加载线程数上限（其余核心留给寻路）
+
+    void workerLoop();
+
+public:
+    // workerCount为0时按硬件线程数自动选择
+    explicit ChunkStreamer(Loader chunkLoader, size_t workerCount = 0);
+    ~ChunkStreamer();
+
+    ChunkStreamer(const ChunkStreamer&) = delete;
+    ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+    // 提交网格加载请求；已提交的网格只更新优先级
+    void request(const GridCoord& coord, int priority);
+
+    // 撤销shouldCancel返回true的待加载网格（持锁调用，shouldCancel不得回调本对象）
+    void cancelIf(const std::function<bool(const GridCoord&)>& shouldCancel);
+
+    // 按当前优先级取回最多maxCount个已完成的网格（追加到out），取回后的坐标可以重新提交
+    void collect(std::vector<CompletedChunk>& out, size_t maxCount);
+};
+
+#endif // CHUNK_STREAMER_H
@@ -178,6 +178,77 @@ float Collider::raycast(float startX, float startY, float dirX, float dirY) cons
     return -1.0f;
 }
 
+// 线段检测（矩形使用slab法，圆形求解二次方程）
+bool Collider::intersectsSegment(float x1, float y1, float x2, float y2, float& outT) const {
+    if (!isActive) {
+        return false;
+    }
+
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+
+    if (type == ColliderType::CIRCLE) {
+        float fx = x1 - circleX;
+        float fy = y1 - circleY;
+
+        float a = dx * dx + dy * dy;
+        if (a < 1e-8f) {
+            return false; // 线段退化为点
+        }
+        float b = 2 * (fx * dx + fy * dy);
+        float c = (fx * fx + fy * fy) - radius * radius;
+
+        float discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) return false;
+
+        discriminant = std::sqrt(discriminant);
+        float t1 = (-b - discriminant) / (2 * a);
+        float t2 = (-b + discriminant) / (2 * a);
+
+        bool hit = false;
+        outT = 1.1f; // 超出线段范围
+        if (t1 >= 0 && t1 <= 1) { outT = t1; hit = true; }
+        if (t2 >= 0 && t2 <= 1 && t2 < outT) { outT = t2; hit = true; }
+        return hit;
+    }
+
+    float tmin = 0.0f, tmax = 1.0f;
+    const float rx = boxCollider.x, ry = boxCollider.y;
+    const float rw = boxCollider.w, rh = boxCollider.h;
+
+    // X轴
+    if (std::abs(dx) < 1e-8) {
+        if (x1 < rx || x1 > rx + rw) return false;
+    } else {
+        float ood = 1.0f / dx;
+        float t1 = (rx - x1) * ood;
+        float t2 = (rx + rw - x1) * ood;
+        if (t1 > t2) std::swap(t1, t2);
+        tmin = std::max(tmin, t1);
+        tmax = std::min(tmax, t2);
+        if (tmin > tmax) return false;
+    }
+
+    // Y轴
+    if (std::abs(dy) < 1e-8) {
+        if (y1 < ry || y1 > ry + rh) return false;
+    } else {
+        float ood = 1.0f / dy;
+        float t1 = (ry - y1) * ood;
+        float t2 = (ry + rh - y1) * ood;
+        if (t1 > t2) std::swap(t1, t2);
+        tmin = std::max(tmin, t1);
+        tmax = std::min(tmax, t2);
+        if (tmin > tmax) return false;
+    }
+
+    if (tmin >= 0.0f && tmin <= 1.0f) {
+        outT = tmin;
+        return true;
+    }
+    return false;
+}
+
 // 新增：射线检测（只检测指定用途的碰撞体）
 float Collider::raycastWithPurpose(float startX, float startY, float dirX, float dirY, ColliderPurpose targetPurpose) const {
     // 检查碰撞体用途是否匹配
@@ -101,6 +101,9 @@ public:
     // 射线检测方法
     float raycast(float startX, float startY, float dirX, float dirY) const;
     
+    // 线段检测：线段(x1,y1)->(x2,y2)与碰撞体相交时返回true，outT为相交处的线段参数（0-1）
+    bool intersectsSegment(float x1, float y1, float x2, float y2, float& outT) const;
+    
     // 新增：射线检测（只检测指定用途的碰撞体）
     float raycastWithPurpose(float startX, float startY, float dirX, float dirY, ColliderPurpose targetPurpose) const;
 };
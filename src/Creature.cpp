@@ -659,45 +659,12 @@ std::vector<ScentSource*> Creature::getSmellableScents(const std::vector<ScentSo
 bool Creature::raycast(float startX, float startY, float endX, float endY) const {
     // 获取游戏实例
     Game* game = Game::getInstance();
-    if (!game) {
+    if (!game || !game->getLineOfSight()) {
         return true; // 如果没有游戏实例，假设没有阻拦
     }
     
-    // 获取所有视觉碰撞箱（统一接口）
-    std::vector<Collider*> visionColliders = game->getAllVisionColliders();
-    
-    // 简单的射线检测实现
-    float dx = endX - startX;
-    float dy = endY - startY;
-    float distance = sqrt(dx * dx + dy * dy);
-    
-    if (distance < 1.0f) {
-        return true; // 距离太近，认为可见
-    }
-    
-    // 归一化方向向量
-    dx /= distance;
-    dy /= distance;
-    
-    // 每隔一定步长检查碰撞
-    float stepSize = 8.0f; // 减小步长，提高精度
-    float currentDistance = 0.0f;
-    
-    while (currentDistance < distance) {
-        float currentX = startX + dx * currentDistance;
-        float currentY = startY + dy * currentDistance;
-        
-        // 检查当前点是否与任何视觉碰撞箱碰撞
-        for (Collider* visionCollider : visionColliders) {
-            if (visionCollider && visionCollider->contains(static_cast<int>(currentX), static_cast<int>(currentY))) {
-                return false; // 被视觉障碍物阻挡
-            }
-        }
-        
-        currentDistance += stepSize;
-    }
-    
-    return true; // 没有被阻挡
+    // 墙体按方块连线检测（本帧内缓存），烟雾按线段精确检测
+    return game->getLineOfSight()->hasLineOfSight(startX, startY, endX, endY);
 }
 
 // 新增：寻路相关方法实现
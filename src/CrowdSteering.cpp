@@ -0,0 +1,128 @@
+#include "CrowdSteering.h"
+#include "Entity.h"
+#include "SpatialHash.h"
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace {
+    // 查询缓冲区（每帧复用，避免分配）
+    std::vector<Entity*> neighborBuffer;
+    std::vector<std::pair<float, const Entity*>> candidateBuffer; // (距离平方, 实体)
+}
+
+void CrowdSteering::steer(const Entity& agent, const SpatialHash& hash, float maxSpeed,
+                          float& velocityX, float& velocityY) {
+    const float agentX = agent.getX();
+    const float agentY = agent.getY();
+    const float agentRadius = static_cast<float>(agent.getRadius());
+
+    // 时间窗口内可能相遇的范围：双方各自最多移动maxSpeed*TIME_HORIZON
+    float reach = agentRadius + hash.getMaxEntityRadius() + PERSONAL_SPACE + 2.0f * maxSpeed * TIME_HORIZON;
+    neighborBuffer.clear();
+    hash.queryRange(agentX, agentY, reach, neighborBuffer);
+
+    candidateBuffer.clear();
+    for (const Entity* other : neighborBuffer) {
+        if (other == &agent || !other->hasCrowdSteering() || other->getHealth() <= 0) {
+            continue;
+        }
+        float dx = other->getX() - agentX;
+        float dy = other->getY() - agentY;
+        candidateBuffer.emplace_back(dx * dx + dy * dy, other);
+    }
+    if (candidateBuffer.empty()) {
+        return;
+    }
+
+    // 只保留最近的几个邻居，密集尸群中开销不随人数增长
+    if (candidateBuffer.size() > MAX_NEIGHBORS) {
+        std::nth_element(candidateBuffer.begin(), candidateBuffer.begin() + MAX_NEIGHBORS, candidateBuffer.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        candidateBuffer.resize(MAX_NEIGHBORS);
+    }
+
+    const float desiredX = velocityX;
+    const float desiredY = velocityY;
+    const float desiredSpeed = std::sqrt(desiredX * desiredX + desiredY * desiredY);
+    float steerX = 0.0f;
+    float steerY = 0.0f;
+
+    for (const auto& [distanceSq, other] : candidateBuffer) {
+        // 对方相对自己的位置
+        float relX = other->getX() - agentX;
+        float relY = other->getY() - agentY;
+        float distance = std::sqrt(distanceSq);
+        float combined = agentRadius + other->getRadius() + PERSONAL_SPACE;
+
+        if (distance < combined) {
+            // 已经贴近：沿连线远离对方，越近越强（完全重合时交给碰撞分离处理）
+            if (distance > 0.01f) {
+                float strength = (combined - distance) / combined * SEPARATION_WEIGHT * maxSpeed;
+                steerX -= relX / distance * strength;
+                steerY -= relY / distance * strength;
+            }
+            continue;
+        }
+
+        // 相对速度（对方使用上一次积分的速度），求 |rel - relVel*t| = combined 的最小正根
+        float relVelX = desiredX - other->getVelocityX();
+        float relVelY = desiredY - other->getVelocityY();
+        float a = relVelX * relVelX + relVelY * relVelY;
+        if (a < 1e-4f) continue;                                   // 同速同向，不会相撞
+
+        float b = relX * relVelX + relY * relVelY;
+        if (b <= 0.0f) continue;                                   // 正在远离
+
+        float c = distanceSq - combined * combined;
+        float discriminant = b * b - a * c;
+        if (discriminant <= 0.0f) continue;                        // 会擦肩而过
+
+        float timeToCollision = (b - std::sqrt(discriminant)) / a;
+        if (timeToCollision >= TIME_HORIZON) continue;
+
+        // 碰撞时刻自己相对对方的方向，沿该方向避开
+        float awayX = relVelX * timeToCollision - relX;
+        float awayY = relVelY * timeToCollision - relY;
+        float awayLength = std::sqrt(awayX * awayX + awayY * awayY);
+        if (awayLength < 0.01f) continue;
+        awayX /= awayLength;
+        awayY /= awayLength;
+
+        // 正面相向时该方向几乎与自身速度相反，只会让双方同时减速；统一偏向各自右侧错开
+        if (desiredSpeed > 0.01f) {
+            float headOn = (awayX * desiredX + awayY * desiredY) / desiredSpeed;
+            if (headOn < -0.9f) {
+                awayX -= desiredY / desiredSpeed;
+                awayY += desiredX / desiredSpeed;
+            }
+        }
+
+        float urgency = (TIME_HORIZON - timeToCollision) / TIME_HORIZON;
+        steerX += awayX * urgency * AVOIDANCE_WEIGHT * maxSpeed;
+        steerY += awayY * urgency * AVOIDANCE_WEIGHT * maxSpeed;
+    }
+
+    float resultX = desiredX + steerX;
+    float resultY = desiredY + steerY;
+
+    // 避让只允许减速和转向，不允许掉头，避免与寻路方向来回拉扯
+    if (desiredSpeed > 0.01f) {
+        float forward = (resultX * desiredX + resultY * desiredY) / desiredSpeed;
+        if (forward < 0.0f) {
+            resultX -= forward * desiredX / desiredSpeed;
+            resultY -= forward * desiredY / desiredSpeed;
+        }
+    }
+
+    float resultSpeed = std::sqrt(resultX * resultX + resultY * resultY);
+    if (resultSpeed > maxSpeed && resultSpeed > 0.0f) {
+        float scale = maxSpeed / resultSpeed;
+        resultX *= scale;
+        resultY *= scale;
+    }
+
+    velocityX = resultX;
+    velocityY = resultY;
+}
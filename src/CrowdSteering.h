@@ -0,0 +1,29 @@
+#pragma once
+#ifndef CROWD_STEERING_H
+#define CROWD_STEERING_H
+
+#include <cstddef>
+
+class Entity;
+class SpatialHash;
+
+// 群体转向（局部避让）
+// 在Entity::updatePhysics积分前修正速度：从空间哈希取出附近同样参与转向的实体，
+// 预测在时间窗口内的碰撞并提前侧向绕开，对已经贴近的同伴施加轻微分离，
+// 让尸群彼此绕行，而不是重叠后再由separateFromEntity硬性推开
+// 只考虑参与转向的实体：追击目标（玩家）不会被避让
+class CrowdSteering {
+public:
+    static constexpr float TIME_HORIZON = 0.75f;       // 预测碰撞的时间窗口（秒）
+    static constexpr float PERSONAL_SPACE = 4.0f;      // 两者半径之和之外额外保留的间距（像素）
+    static constexpr float AVOIDANCE_WEIGHT = 1.0f;    // 避让速度占最大速度的比例（碰撞迫在眉睫时）
+    static constexpr float SEPARATION_WEIGHT = 0.5f;   // 完全重叠时分离速度占最大速度的比例
+    static constexpr size_t MAX_NEIGHBORS = 8;         // 最多考虑的最近邻居数
+
+    // 修正agent本帧的速度（velocityX/Y传入期望速度，返回修正后的速度，大小不超过maxSpeed）
+    // 只在主线程调用（使用共享的查询缓冲区）
+    static void steer(const Entity& agent, const SpatialHash& hash, float maxSpeed,
+                      float& velocityX, float& velocityY);
+};
+
+#endif // CROWD_STEERING_H
@@ -13,6 +13,8 @@
 #include "Damage.h" // 添加Damage.h头文件
 #include "EntityFlag.h" // 添加EntityFlag.h头文件
 #include "Constants.h" // 添加Constants.h头文件
+#include "SpatialHash.h" // 宽相位碰撞检测
+#include "CrowdSteering.h" // 群体转向
 
 // 在现有的Entity.cpp文件中添加以下内容
 
@@ -25,7 +27,7 @@ Entity::Entity(float startX, float startY, int entityRadius, int entitySpeed, in
       shootCooldown(0),
       // 初始化物理引擎属性
       velocityX(0.0f), velocityY(0.0f), desiredVelocityX(0.0f), desiredVelocityY(0.0f),
-      mass(1.0f), isStatic(false),
+      mass(1.0f), isStatic(false), spatialHash(nullptr), crowdSteering(false),
       // 初始化碰撞信息向量
       collisions(),
       // 初始化新增属性
@@ -889,21 +891,21 @@ void Entity::maintainWeapon(Gun* weapon) {
 }
 
 // 向指定方向射击
-Bullet* Entity::shootInDirection(Gun* weapon, float dirX, float dirY) {
+bool Entity::shootInDirection(Gun* weapon, float dirX, float dirY) {
     if (!canShoot(weapon)) {
-        return nullptr;
+        return false;
     }
     
     // 获取游戏实例
     Game* game = Game::getInstance();
     if (!game) {
-        return nullptr;
+        return false;
     }
     
     // 射击武器
     auto shotAmmo = weapon->shoot();
     if (!shotAmmo) {
-        return nullptr; // 射击失败
+        return false; // 射击失败
     }
     
     // 设置射击冷却 - 修正射速计算
@@ -1013,6 +1015,11 @@ void Entity::reloadWeaponWithActions(Gun* weapon) {
 
 // 虚析构函数实现
 Entity::~Entity() {
+    // 从空间哈希中移除，避免留下悬空指针
+    if (spatialHash) {
+        spatialHash->remove(this);
+    }
+    
     // 清理ActionQueue，防止内存访问冲突
     if (actionQueue) {
         actionQueue->pause();
@@ -1238,6 +1245,11 @@ void Entity::updatePhysics(float deltaTime) {
     velocityX = desiredVelocityX;
     velocityY = desiredVelocityY;
     
+    // 参与群体转向的实体先绕开前方的同伴（只修正本帧速度，期望速度保持AI给出的值）
+    if (crowdSteering && spatialHash) {
+        CrowdSteering::steer(*this, *spatialHash, maxSpeed, velocityX, velocityY);
+    }
+    
     // 3. 预测新位置
     float newX = x + velocityX * deltaTime;
     float newY = y + velocityY * deltaTime;
@@ -1253,6 +1265,11 @@ void Entity::updatePhysics(float deltaTime) {
     
     // 6. 更新碰撞体位置
     collider.updatePosition(x, y);
+    
+    // 7. 增量更新空间哈希中的格子
+    if (spatialHash) {
+        spatialHash->update(this);
+    }
 }
 
 // 应用外力 - 简化版本，直接设置期望速度
@@ -1313,6 +1330,9 @@ void Entity::separateFromEntity(Entity* other, const CollisionInfo& info) {
         x += info.normalX * baseSeparationDistance;
         y += info.normalY * baseSeparationDistance;
         collider.updatePosition(x, y);
+        if (spatialHash) {
+            spatialHash->update(this);
+        }
         return;
     }
     
@@ -1371,6 +1391,14 @@ void Entity::separateFromEntity(Entity* other, const CollisionInfo& info) {
     // 更新碰撞体位置
     collider.updatePosition(x, y);
     other->collider.updatePosition(other->x, other->y);
+    
+    // 更新空间哈希中的格子
+    if (spatialHash) {
+        spatialHash->update(this);
+    }
+    if (other->spatialHash) {
+        other->spatialHash->update(other);
+    }
 }
 
 // 检查地形碰撞
@@ -1397,16 +1425,20 @@ void Entity::checkTerrainCollisionAtPosition(float& newX, float& newY) {
     int maxTileY = GameConstants::worldToTileCoord(newY + radius);
     
     // 检查与地形的碰撞
+    Map* map = game->getMap();
     for (int tileX = minTileX; tileX <= maxTileX; tileX++) {
         for (int tileY = minTileY; tileY <= maxTileY; tileY++) {
-            Tile* tile = game->getMap()->getTileAt(GameConstants::tileCoordToWorld(tileX), GameConstants::tileCoordToWorld(tileY));
-            if (tile && tile->hasColliderWithPurpose(ColliderPurpose::TERRAIN)) {
-                auto terrainColliders = tile->getCollidersByPurpose(ColliderPurpose::TERRAIN);
-                for (Collider* terrainCollider : terrainColliders) {
-                    if (tempCollider->intersects(*terrainCollider)) {
-                        // 发生地形碰撞，计算分离
-                        resolveTerrainCollision(newX, newY, *terrainCollider);
-                    }
+            // 先查网格的可通行位图，没有地形碰撞箱的方块不再访问方块本身
+            if (map->isTileWalkable(tileX, tileY)) continue;
+            
+            Tile* tile = map->getTileAtTile(tileX, tileY);
+            if (!tile) continue;
+            
+            for (const auto& terrainCollider : tile->getColliders()) {
+                if (terrainCollider->getPurpose() == ColliderPurpose::TERRAIN &&
+                    tempCollider->intersects(*terrainCollider)) {
+                    // 发生地形碰撞，计算分离
+                    resolveTerrainCollision(newX, newY, *terrainCollider);
                 }
             }
         }
@@ -15,10 +15,10 @@
 #include "EntityFlag.h" // 添加实体标志头文件
 
 // 前向声明
-class Bullet;
 class Game;
 class Gun;
 class Magazine;
+class SpatialHash;
 
 // 实体阵营枚举
 enum class Faction {
@@ -77,6 +77,8 @@ protected:
     float desiredVelocityX, desiredVelocityY; // 期望速度
     float mass;                           // 质量（用于碰撞分离）
     bool isStatic;                        // 是否为静态物体
+    SpatialHash* spatialHash;             // 所在的空间哈希（宽相位碰撞检测）
+    bool crowdSteering;                   // 是否参与群体转向（积分前绕开附近同伴）
 
 public:
     // 碰撞响应相关结构体（移到public以便访问）
@@ -203,8 +205,8 @@ public:
     // 武器操作行为封装
 
         // 射击相关接口 - 修改现有方法
-        // 向指定方向射击，返回创建的子弹（如果成功）
-    Bullet* shootInDirection(Gun* weapon, float dirX, float dirY);
+        // 向指定方向射击，成功发射子弹时返回true
+    bool shootInDirection(Gun* weapon, float dirX, float dirY);
 
     // 自动选择存储空间中最合适的弹匣进行换弹
     float reloadWeaponAuto(Gun* weapon);
@@ -303,6 +305,14 @@ public:
     bool getIsStatic() const { return isStatic; }
     void setIsStatic(bool static_) { isStatic = static_; }
     
+    // 空间哈希（由SpatialHash::insert/remove维护）
+    SpatialHash* getSpatialHash() const { return spatialHash; }
+    void setSpatialHash(SpatialHash* hash) { spatialHash = hash; }
+    
+    // 群体转向（见CrowdSteering）
+    bool hasCrowdSteering() const { return crowdSteering; }
+    void setCrowdSteering(bool enabled) { crowdSteering = enabled; }
+    
     // 物理更新方法
     void updatePhysics(float deltaTime);
     void applyForce(float forceX, float forceY);
@@ -0,0 +1,130 @@
+#include "FieldOfView.h"
+#include "Map.h"
+#include <algorithm>
+
+FieldOfView::FieldOfView()
+    : originTileX(0), originTileY(0), radius(0), windowSize(1),
+      opaque(1, 0), visible(1, 0) {
+}
+
+int FieldOfView::toIndex(int tileX, int tileY) const {
+    int localX = tileX - originTileX + radius;
+    int localY = tileY - originTileY + radius;
+    if (localX < 0 || localY < 0 || localX >= windowSize || localY >= windowSize) {
+        return -1;
+    }
+    return localY * windowSize + localX;
+}
+
+bool FieldOfView::isOpaqueAt(int tileX, int tileY) const {
+    int index = toIndex(tileX, tileY);
+    return index >= 0 && opaque[index] != 0;
+}
+
+void FieldOfView::markVisible(int tileX, int tileY) {
+    int index = toIndex(tileX, tileY);
+    if (index >= 0) {
+        visible[index] = 1;
+    }
+}
+
+void FieldOfView::clear() {
+    std::fill(visible.begin(), visible.end(), 0);
+}
+
+void FieldOfView::compute(const Map* map, int tileX, int tileY, int viewRadius) {
+    originTileX = tileX;
+    originTileY = tileY;
+    radius = std::max(0, viewRadius);
+    windowSize = 2 * radius + 1;
+
+    // 复用容量，只在视野半径变大时分配
+    size_t cellCount = static_cast<size_t>(windowSize) * windowSize;
+    opaque.assign(cellCount, 0);
+    visible.assign(cellCount, 0);
+
+    // 一次性读取窗口内方块的不透明位图，投射过程中只访问数组
+    if (map) {
+        for (int localY = 0; localY < windowSize; ++localY) {
+            int tileY = originTileY - radius + localY;
+            for (int localX = 0; localX < windowSize; ++localX) {
+                if (map->isTileOpaque(originTileX - radius + localX, tileY)) {
+                    opaque[localY * windowSize + localX] = 1;
+                }
+            }
+        }
+    }
+
+    markVisible(originTileX, originTileY);
+
+    // 8个八分区的坐标变换系数
+    static const int multipliers[4][8] = {
+        { 1, 0, 0, -1, -1, 0, 0, 1 },
+        { 0, 1, -1, 0, 0, -1, 1, 0 },
+        { 0, 1, 1, 0, 0, -1, -1, 0 },
+        { 1, 0, 0, 1, -1, 0, 0, -1 }
+    };
+    for (int octant = 0; octant < 8; ++octant) {
+        castLight(1, 1.0f, 0.0f,
+                  multipliers[0][octant], multipliers[1][octant],
+                  multipliers[2][octant], multipliers[3][octant]);
+    }
+}
+
+void FieldOfView::castLight(int row, float startSlope, float endSlope, int xx, int xy, int yx, int yy) {
+    if (startSlope < endSlope) {
+        return;
+    }
+
+    float nextStartSlope = startSlope;
+    for (int distance = row; distance <= radius; ++distance) {
+        bool blocked = false;
+        int dy = -distance;
+
+        for (int dx = -distance; dx <= 0; ++dx) {
+            // 方块左右边缘相对观察者的斜率
+            float leftSlope = (dx - 0.5f) / (dy + 0.5f);
+            float rightSlope = (dx + 0.5f) / (dy - 0.5f);
+
+            if (startSlope < rightSlope) {
+                continue;
+            } else if (endSlope > leftSlope) {
+                break;
+            }
+
+            int tileX = originTileX + dx * xx + dy * xy;
+            int tileY = originTileY + dx * yx + dy * yy;
+
+            // 光线照到的方块都可见（包括不透明方块本身）
+            markVisible(tileX, tileY);
+
+            bool tileOpaque = isOpaqueAt(tileX, tileY);
+            if (blocked) {
+                if (tileOpaque) {
+                    nextStartSlope = rightSlope;
+                    continue;
+                }
+                blocked = false;
+                startSlope = nextStartSlope;
+            } else if (tileOpaque && distance < radius) {
+                // 遇到遮挡：先递归处理遮挡前的部分，再从遮挡后继续
+                blocked = true;
+                castLight(distance + 1, startSlope, leftSlope, xx, xy, yx, yy);
+                nextStartSlope = rightSlope;
+            }
+        }
+
+        if (blocked) {
+            break;
+        }
+    }
+}
+
+bool FieldOfView::isTileVisible(int tileX, int tileY) const {
+    int index = toIndex(tileX, tileY);
+    return index >= 0 && visible[index] != 0;
+}
+
+bool FieldOfView::isPointVisible(float worldX, float worldY) const {
+    return isTileVisible(Map::worldToTileIndex(worldX), Map::worldToTileIndex(worldY));
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef FIELD_OF_VIEW_H
+#define FIELD_OF_VIEW_H
+
+#include <vector>
+#include <cstdint>
+
+class Map; // 前向声明
+
+// 方块视野（递归阴影投射 Recursive Shadowcasting）
+// 以观察者所在方块为中心，在边长为2*radius+1的方块窗口内按8个八分区投射光线，
+// 不透明方块（Tile::getIsTransparent()为false）遮挡其后方的方块
+// 计算结果是每个方块是否可见，可供渲染（战争迷雾）和AI复用
+class FieldOfView {
+private:
+    int originTileX, originTileY;   // 观察者所在方块
+    int radius;                     // 视野半径（方块）
+    int windowSize;                 // 窗口边长 = 2 * radius + 1
+    std::vector<uint8_t> opaque;    // 窗口内方块是否不透明（计算开始时从地图读取一次）
+    std::vector<uint8_t> visible;   // 窗口内方块是否可见
+
+    // 全局方块坐标转窗口下标，窗口外返回-1
+    int toIndex(int tileX, int tileY) const;
+
+    bool isOpaqueAt(int tileX, int tileY) const;
+    void markVisible(int tileX, int tileY);
+
+    // 在一个八分区内递归投射光线（xx/xy/yx/yy为八分区变换系数）
+    void castLight(int row, float startSlope, float endSlope, int xx, int xy, int yx, int yy);
+
+public:
+    FieldOfView();
+
+    // 以(tileX, tileY)为观察者、viewRadius为半径重新计算视野
+    void compute(const Map* map, int tileX, int tileY, int viewRadius);
+
+    // 清空视野（所有方块均不可见）
+    void clear();
+
+    // 查询方块是否可见（窗口外视为不可见）
+    bool isTileVisible(int tileX, int tileY) const;
+
+    // 查询世界坐标所在方块是否可见
+    bool isPointVisible(float worldX, float worldY) const;
+
+    // 获取器
+    int getOriginTileX() const { return originTileX; }
+    int getOriginTileY() const { return originTileY; }
+    int getRadius() const { return radius; }
+};
+
+#endif // FIELD_OF_VIEW_H
@@ -0,0 +1,300 @@
+#include "FlowField.h"
+#include "Map.h"
+#include "Constants.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+namespace {
+    const float UNREACHABLE = std::numeric_limits<float>::max();
+    const float DIAGONAL_STEP = 1.414f;
+}
+
+FlowFieldService::FlowFieldService(Map* gameMap)
+    : map(gameMap), terrain(gameMap), frame(0) {
+}
+
+int FlowFieldService::toIndex(const Field& field, int tileX, int tileY) const {
+    int localX = tileX - field.originX;
+    int localY = tileY - field.originY;
+    if (localX < 0 || localY < 0 || localX >= FIELD_SIDE || localY >= FIELD_SIDE) {
+        return -1;
+    }
+    return localY * FIELD_SIDE + localX;
+}
+
+void FlowFieldService::beginFrame() {
+    frame++;
+
+    fields.erase(std::remove_if(fields.begin(), fields.end(), [this](const Field& field) {
+        return frame - field.lastUsedFrame > MAX_IDLE_FRAMES;
+    }), fields.end());
+}
+
+void FlowFieldService::propagate(Field& field) {
+    std::greater<std::pair<float, int>> compare;
+
+    while (!openHeap.empty()) {
+        std::pop_heap(openHeap.begin(), openHeap.end(), compare);
+        auto [value, index] = openHeap.back();
+        openHeap.pop_back();
+        if (value > field.distance[index]) {
+            continue; // 过期的堆项
+        }
+
+        int localX = index % FIELD_SIDE;
+        int localY = index / FIELD_SIDE;
+        float enterCost = field.cost[index]; // 邻居移动到当前方块的耗时
+
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0) continue;
+                int nx = localX + dx;
+                int ny = localY + dy;
+                if (nx < 0 || ny < 0 || nx >= FIELD_SIDE || ny >= FIELD_SIDE) continue;
+
+                int neighbor = ny * FIELD_SIDE + nx;
+                if (field.cost[neighbor] < 0) continue;
+
+                // 对角线不切角：两侧的直线方块都必须可通行，避免生物贴墙卡住
+                bool diagonal = dx != 0 && dy != 0;
+                if (diagonal && (field.cost[localY * FIELD_SIDE + nx] < 0 || field.cost[ny * FIELD_SIDE + localX] < 0)) {
+                    continue;
+                }
+
+                float candidate = value + enterCost * (diagonal ? DIAGONAL_STEP : 1.0f);
+                if (candidate < field.distance[neighbor]) {
+                    field.distance[neighbor] = candidate;
+                    openHeap.emplace_back(candidate, neighbor);
+                    std::push_heap(openHeap.begin(), openHeap.end(), compare);
+                }
+            }
+        }
+    }
+}
+
+void FlowFieldService::getGridRange(const Field& field, int& minGridX, int& minGridY, int& maxGridX, int& maxGridY) const {
+    int localIndex;
+    Map::splitTileIndex(field.originX, minGridX, localIndex);
+    Map::splitTileIndex(field.originY, minGridY, localIndex);
+    Map::splitTileIndex(field.originX + FIELD_SIDE - 1, maxGridX, localIndex);
+    Map::splitTileIndex(field.originY + FIELD_SIDE - 1, maxGridY, localIndex);
+}
+
+bool FlowFieldService::isTerrainStale(Field& field) {
+    if (field.checkedFrame == frame) {
+        return false;
+    }
+    field.checkedFrame = frame;
+
+    int minGridX, minGridY, maxGridX, maxGridY;
+    getGridRange(field, minGridX, minGridY, maxGridX, maxGridY);
+    size_t stampIndex = 0;
+    for (int gridY = minGridY; gridY <= maxGridY; ++gridY) {
+        for (int gridX = minGridX; gridX <= maxGridX; ++gridX) {
+            const Grid* grid = map ? map->getGridAtCoord(gridX, gridY) : nullptr;
+            const GridStamp& stamp = field.gridStamps[stampIndex++];
+            if (stamp.grid != grid || (grid && stamp.revision != grid->getRevision())) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void FlowFieldService::rebuild(Field& field, int targetTileX, int targetTileY) {
+    field.targetX = targetTileX;
+    field.targetY = targetTileY;
+    field.originX = targetTileX - FIELD_RADIUS;
+    field.originY = targetTileY - FIELD_RADIUS;
+    field.incrementalUpdates = 0;
+    field.checkedFrame = frame;
+
+    // 记录窗口覆盖的网格，地形变化时重建
+    int minGridX, minGridY, maxGridX, maxGridY;
+    getGridRange(field, minGridX, minGridY, maxGridX, maxGridY);
+    field.gridStamps.clear();
+    for (int gridY = minGridY; gridY <= maxGridY; ++gridY) {
+        for (int gridX = minGridX; gridX <= maxGridX; ++gridX) {
+            const Grid* grid = map ? map->getGridAtCoord(gridX, gridY) : nullptr;
+            field.gridStamps.push_back({grid, grid ? grid->getRevision() : 0});
+        }
+    }
+
+    // 读取窗口内的地形快照，传播过程中只访问数组
+    const size_t cellCount = static_cast<size_t>(FIELD_SIDE) * FIELD_SIDE;
+    field.cost.resize(cellCount);
+    field.distance.assign(cellCount, UNREACHABLE);
+    for (int localY = 0; localY < FIELD_SIDE; ++localY) {
+        for (int localX = 0; localX < FIELD_SIDE; ++localX) {
+            int tileX = field.originX + localX;
+            int tileY = field.originY + localY;
+            field.cost[localY * FIELD_SIDE + localX] = terrain.isWalkable(tileX, tileY)
+                ? terrain.getTerrainCost(tileX, tileY) / 100.0f
+                : -1.0f;
+        }
+    }
+
+    int targetIndex = toIndex(field, targetTileX, targetTileY);
+    if (field.cost[targetIndex] < 0) {
+        return; // 目标方块不可通行，整个流场不可达
+    }
+
+    field.distance[targetIndex] = 0.0f;
+    openHeap.clear();
+    openHeap.emplace_back(0.0f, targetIndex);
+    propagate(field);
+}
+
+void FlowFieldService::retarget(Field& field, int targetTileX, int targetTileY) {
+    int oldIndex = toIndex(field, field.targetX, field.targetY);
+    int newIndex = toIndex(field, targetTileX, targetTileY);
+
+    bool canIncrement = field.incrementalUpdates < MAX_INCREMENTAL_UPDATES &&
+                        std::abs(targetTileX - (field.originX + FIELD_RADIUS)) <= RECENTER_DISTANCE &&
+                        std::abs(targetTileY - (field.originY + FIELD_RADIUS)) <= RECENTER_DISTANCE &&
+                        newIndex >= 0 && oldIndex >= 0 &&
+                        field.cost[newIndex] >= 0 && field.distance[oldIndex] < UNREACHABLE;
+    if (!canIncrement) {
+        rebuild(field, targetTileX, targetTileY);
+        return;
+    }
+
+    // 新目标的代价设为比旧目标还低一步以上，成为唯一的最低点；
+    // 之后只向代价降低的方块传播：未更新的方块仍有比自己低的邻居（旧路径指向旧目标，旧目标指向新目标），
+    // 更新过的方块沿新的最短路径指向新目标，因此沿流场下降总能到达新目标
+    bool diagonal = targetTileX != field.targetX && targetTileY != field.targetY;
+    float step = field.cost[newIndex] * (diagonal ? DIAGONAL_STEP : 1.0f);
+    float newValue = field.distance[oldIndex] - step - 1.0f;
+
+    field.targetX = targetTileX;
+    field.targetY = targetTileY;
+    field.incrementalUpdates++;
+
+    if (newValue < field.distance[newIndex]) {
+        field.distance[newIndex] = newValue;
+        openHeap.clear();
+        openHeap.emplace_back(newValue, newIndex);
+        propagate(field);
+    }
+}
+
+FlowFieldService::Field* FlowFieldService::acquireField(int targetTileX, int targetTileY) {
+    // 已有同一目标的流场（地形变化后以同一目标重建）
+    for (Field& field : fields) {
+        if (field.targetX == targetTileX && field.targetY == targetTileY) {
+            if (isTerrainStale(field)) {
+                rebuild(field, targetTileX, targetTileY);
+            }
+            return &field;
+        }
+    }
+
+    // 目标移动了一格：本帧尚未被其他生物使用的流场可以增量更新（地形变化后直接重建）
+    for (Field& field : fields) {
+        if (field.lastUsedFrame != frame &&
+            std::abs(field.targetX - targetTileX) <= 1 && std::abs(field.targetY - targetTileY) <= 1) {
+            if (isTerrainStale(field)) {
+                rebuild(field, targetTileX, targetTileY);
+            } else {
+                retarget(field, targetTileX, targetTileY);
+            }
+            return &field;
+        }
+    }
+
+    if (fields.size() < MAX_FIELDS) {
+        fields.emplace_back();
+        rebuild(fields.back(), targetTileX, targetTileY);
+        return &fields.back();
+    }
+
+    // 复用最久未使用的流场
+    Field* oldest = nullptr;
+    for (Field& field : fields) {
+        if (field.lastUsedFrame != frame && (!oldest || field.lastUsedFrame < oldest->lastUsedFrame)) {
+            oldest = &field;
+        }
+    }
+    if (oldest) {
+        rebuild(*oldest, targetTileX, targetTileY);
+    }
+    return oldest;
+}
+
+bool FlowFieldService::sampleDirection(float targetWorldX, float targetWorldY, float worldX, float worldY,
+                                       float intelligence, float& outDirX, float& outDirY, float& outMoveCost) {
+    int targetTileX = Map::worldToTileIndex(targetWorldX);
+    int targetTileY = Map::worldToTileIndex(targetWorldY);
+    int tileX = Map::worldToTileIndex(worldX);
+    int tileY = Map::worldToTileIndex(worldY);
+
+    // 按智能程度限制采样半径
+    float radius = std::min(static_cast<float>(FIELD_RADIUS), intelligence * RADIUS_PER_INTELLIGENCE);
+    float offsetX = static_cast<float>(tileX - targetTileX);
+    float offsetY = static_cast<float>(tileY - targetTileY);
+    if (offsetX * offsetX + offsetY * offsetY > radius * radius) {
+        return false;
+    }
+
+    Field* field = acquireField(targetTileX, targetTileY);
+    if (!field) {
+        return false;
+    }
+    field->lastUsedFrame = frame;
+
+    int index = toIndex(*field, tileX, tileY);
+    if (index < 0 || field->distance[index] == UNREACHABLE) {
+        return false;
+    }
+
+    // 已在目标方块内：直接朝目标点移动
+    if (tileX == targetTileX && tileY == targetTileY) {
+        float dx = targetWorldX - worldX;
+        float dy = targetWorldY - worldY;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < 1.0f) return false;
+        outDirX = dx / length;
+        outDirY = dy / length;
+        outMoveCost = std::max(field->cost[index], 0.01f);
+        return true;
+    }
+
+    // 在周围8格中选代价最低的方块（与传播相同的不切角规则）
+    int bestIndex = -1;
+    int bestX = 0, bestY = 0;
+    float bestValue = field->distance[index];
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue;
+            int neighbor = toIndex(*field, tileX + dx, tileY + dy);
+            if (neighbor < 0 || field->distance[neighbor] >= bestValue) continue;
+
+            if (dx != 0 && dy != 0) {
+                int sideA = toIndex(*field, tileX + dx, tileY);
+                int sideB = toIndex(*field, tileX, tileY + dy);
+                if (sideA < 0 || sideB < 0 || field->cost[sideA] < 0 || field->cost[sideB] < 0) continue;
+            }
+
+            bestIndex = neighbor;
+            bestValue = field->distance[neighbor];
+            bestX = tileX + dx;
+            bestY = tileY + dy;
+        }
+    }
+    if (bestIndex < 0) {
+        return false;
+    }
+
+    // 朝下一个方块的中心移动
+    float dx = bestX * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET - worldX;
+    float dy = bestY * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET - worldY;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length < 1.0f) return false;
+
+    outDirX = dx / length;
+    outDirY = dy / length;
+    outMoveCost = std::max(field->cost[bestIndex], 0.01f);
+    return true;
+}
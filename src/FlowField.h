@@ -0,0 +1,87 @@
+#pragma once
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <vector>
+#include <cstdint>
+#include "Pathfinding.h"
+
+class Map; // 前向声明
+class Grid;
+
+// 共享流场服务（Dijkstra地图）
+// 以目标方块为中心的方形窗口内，从目标出发做一次Dijkstra，得到每个方块到目标的代价；
+// 追击同一目标的所有生物共用一份流场，每只生物每帧只需比较所在方块周围8格即可得到移动方向
+// - 目标移动到相邻方块时增量更新：新目标成为新的最低点，只向代价降低的方块传播
+// - 目标离开窗口中心太远、跳跃多格或增量次数过多时整体重建（同时刷新地形快照）
+// - 窗口覆盖的网格被修改、加载或卸载（网格指针或修订号变化）时整体重建，每个流场每帧最多检查一次
+class FlowFieldService {
+private:
+    // 重建时窗口覆盖的网格及其修订号（未加载的网格为空）
+    struct GridStamp {
+        const Grid* grid;
+        uint32_t revision;
+    };
+
+    struct Field {
+        int targetX, targetY;            // 当前目标方块
+        int originX, originY;            // 窗口左上角方块
+        int incrementalUpdates;          // 上次重建后的增量更新次数
+        uint32_t lastUsedFrame;          // 最近一次被采样的帧
+        uint32_t checkedFrame;           // 最近一次检查地形快照是否过期的帧
+        std::vector<GridStamp> gridStamps; // 窗口覆盖的网格（行优先），用于检测地形变化
+        std::vector<float> cost;         // 地形快照：进入方块的耗时倍数，负数表示不可通行
+        std::vector<float> distance;     // 到目标的代价（增量更新后为相对值，只用于比较相邻方块）
+    };
+
+    Map* map;
+    AStar terrain;                       // 复用AStar的可通行性和地形耗时查询
+    std::vector<Field> fields;
+    std::vector<std::pair<float, int>> openHeap;
+    uint32_t frame;
+
+    static constexpr int FIELD_RADIUS = 48;              // 流场半径（方块）
+    static constexpr int FIELD_SIDE = 2 * FIELD_RADIUS + 1;
+    static constexpr float RADIUS_PER_INTELLIGENCE = 12.0f; // 每点智能程度可使用流场的方块半径
+    static constexpr size_t MAX_FIELDS = 8;              // 同时存在的流场数量上限
+    static constexpr int RECENTER_DISTANCE = 12;         // 目标偏离窗口中心超过该方块数时重建
+    static constexpr int MAX_INCREMENTAL_UPDATES = 16;   // 连续增量更新次数上限
+    static constexpr uint32_t MAX_IDLE_FRAMES = 120;     // 超过该帧数未被采样的流场被丢弃
+
+    int toIndex(const Field& field, int tileX, int tileY) const;
+
+    // 获取目标方块的流场：命中则直接返回，目标移动一格的流场增量更新，否则新建或重建
+    // 流场已满且都在本帧使用中时返回nullptr
+    Field* acquireField(int targetTileX, int targetTileY);
+
+    // 以新目标整体重建流场（重新读取地形快照）
+    void rebuild(Field& field, int targetTileX, int targetTileY);
+
+    // 窗口覆盖的网格范围（网格坐标）
+    void getGridRange(const Field& field, int& minGridX, int& minGridY, int& maxGridX, int& maxGridY) const;
+
+    // 本帧首次使用时检查窗口覆盖的网格是否与重建时一致，返回地形快照是否已过期
+    bool isTerrainStale(Field& field);
+
+    // 目标移动到相邻方块时的增量更新，无法增量时退回重建
+    void retarget(Field& field, int targetTileX, int targetTileY);
+
+    // 从openHeap中的种子开始做只降不升的Dijkstra传播（不切角）
+    void propagate(Field& field);
+
+public:
+    explicit FlowFieldService(Map* gameMap);
+
+    // 每帧调用一次：推进帧计数并丢弃长期未使用的流场
+    void beginFrame();
+
+    // 采样位于(worldX, worldY)的生物追击(targetWorldX, targetWorldY)时的移动方向
+    // 采样半径按智能程度限制为 intelligence * RADIUS_PER_INTELLIGENCE 方块（不超过流场半径）
+    // 返回false表示超出采样半径、目标不可达或流场不可用，调用方应退回单独寻路
+    bool sampleDirection(float targetWorldX, float targetWorldY, float worldX, float worldY,
+                         float intelligence, float& outDirX, float& outDirY, float& outMoveCost);
+
+    size_t getFieldCount() const { return fields.size(); }
+};
+
+#endif // FLOW_FIELD_H
@@ -17,7 +17,7 @@
 
 Fragment::Fragment(float startX, float startY, float dirX, float dirY, 
                  float speed, float range, int damageValue, Entity* fragmentOwner)
-    : x(startX), y(startY), startX(startX), startY(startY), 
+    : x(startX), y(startY), prevX(startX), prevY(startY), startX(startX), startY(startY), 
       dirX(dirX), dirY(dirY), speed(speed), maxRange(range),
       traveledDistance(0.0f), active(true), owner(fragmentOwner),
       size(2.0f), lifetime(0.0f), maxLifetime(5.0f),
@@ -75,6 +75,8 @@ void Fragment::update(float deltaTime) {
     }
     
     // 更新位置
+    prevX = x;
+    prevY = y;
     x = newX;
     y = newY;
 }
@@ -128,60 +130,51 @@ void Fragment::render(SDL_Renderer* renderer, int cameraX, int cameraY) {
     }
 }
 
-bool Fragment::checkTerrainCollision(const std::vector<Collider>& terrainColliders) {
-    if (!active) return false;
+void Fragment::handleCollision() {
+    active = false;
     
-    for (const auto& collider : terrainColliders) {
-        if (collider.getPurpose() == ColliderPurpose::TERRAIN && 
-            collider.getIsActive() &&
-            checkPointCollision(x, y, collider)) {
-            printf("弹片命中地形碰撞箱\n");
-            handleCollision();
-            return true;
-        }
-    }
-    return false;
+    // 可以在这里添加碰撞效果，比如火花、声音等
+    printf("弹片在位置(%.1f, %.1f)碰撞并消失，飞行距离%.1f/%.1f\n", x, y, traveledDistance, maxRange);
 }
 
-bool Fragment::checkEntityCollision(const std::vector<Entity*>& entities) {
-    if (!active) return false;
+bool Fragment::sweep(const Map* map, const SpatialHash* entityHash, std::vector<Entity*>& entityBuffer) {
+    if (!active || !map) return false;
+    
+    // 遍历本帧移动线段经过的方块，收集实体候选并找到最近的地形命中
+    entityBuffer.clear();
+    float terrainT;
+    bool hitTerrain = map->sweepSegment(prevX, prevY, x, y, entityHash, entityBuffer, terrainT);
     
-    for (Entity* entity : entities) {
-        if (!entity) continue;
+    // 弹片伤害所有存活实体（包括拥有者自己），取地形命中点之前最近的一个
+    float minT = hitTerrain ? terrainT : 1.1f;
+    Entity* hitEntity = nullptr;
+    for (Entity* entity : entityBuffer) {
+        if (!entity || entity->getHealth() <= 0) continue;
         
-        // 弹片伤害所有实体，包括拥有者自己
-        const Collider& entityCollider = entity->getCollider();
-        if (checkPointCollision(x, y, entityCollider)) {
-            // 造成伤害
-            entity->takeDamage(damage);
-            printf("弹片命中实体，造成%d点伤害\n", damage.getTotalDamage());
-            handleCollision();
-            return true;
+        float t;
+        if (entity->getCollider().intersectsSegment(prevX, prevY, x, y, t) && t < minT) {
+            minT = t;
+            hitEntity = entity;
         }
     }
-    return false;
-}
-
-bool Fragment::checkPointCollision(float px, float py, const Collider& collider) const {
-    if (!collider.getIsActive()) return false;
     
-    if (collider.getType() == ColliderType::CIRCLE) {
-        float dx = px - collider.getCircleX();
-        float dy = py - collider.getCircleY();
-        return (dx * dx + dy * dy) <= (collider.getRadius() * collider.getRadius());
-    } else if (collider.getType() == ColliderType::BOX) {
-        const SDL_FRect& box = collider.getBoxCollider();
-        return (px >= box.x && px <= box.x + box.w && 
-                py >= box.y && py <= box.y + box.h);
+    if (hitEntity) {
+        x = prevX + (x - prevX) * minT;
+        y = prevY + (y - prevY) * minT;
+        hitEntity->takeDamage(damage);
+        printf("弹片命中实体，造成%d点伤害\n", damage.getTotalDamage());
+        handleCollision();
+        return true;
     }
-    return false;
-}
-
-void Fragment::handleCollision() {
-    active = false;
     
-    // 可以在这里添加碰撞效果，比如火花、声音等
-    printf("弹片在位置(%.1f, %.1f)碰撞并消失，飞行距离%.1f/%.1f\n", x, y, traveledDistance, maxRange);
+    if (hitTerrain) {
+        x = prevX + (x - prevX) * terrainT;
+        y = prevY + (y - prevY) * terrainT;
+        printf("弹片命中地形碰撞箱\n");
+        handleCollision();
+        return true;
+    }
+    return false;
 }
 
 float Fragment::getDistanceToTarget(float targetX, float targetY) const {
@@ -226,38 +219,7 @@ void FragmentManager::update(float deltaTime) {
     // 获取游戏实例进行碰撞检测
     Game* game = Game::getInstance();
     if (game) {
-        // 获取地形碰撞器
-        std::vector<Collider> terrainColliders;
-        if (game->getMap()) {
-            terrainColliders = game->getMap()->getObstacles();
-        }
-        
-        // 获取所有实体
-        std::vector<Entity*> allEntities;
-        
-        // 添加玩家
-        if (game->getPlayer()) {
-            allEntities.push_back(game->getPlayer());
-        }
-        
-        // 添加所有丧尸
-        const auto& zombies = game->getZombies();
-        for (const auto& zombie : zombies) {
-            if (zombie && zombie->getHealth() > 0) {
-                allEntities.push_back(zombie.get());
-            }
-        }
-        
-        // 添加所有生物
-        const auto& creatures = game->getCreatures();
-        for (const auto& creature : creatures) {
-            if (creature && creature->getHealth() > 0) {
-                allEntities.push_back(creature.get());
-            }
-        }
-        
-        // 执行碰撞检测
-        checkFragmentCollisions(terrainColliders, allEntities);
+        checkFragmentCollisions(game->getMap(), game->getEntitySpatialHash());
     }
     
     clearInactiveFragments();
@@ -297,17 +259,11 @@ void FragmentManager::clearAllFragments() {
     fragments.clear();
 }
 
-void FragmentManager::checkFragmentCollisions(const std::vector<Collider>& terrainColliders, 
-                                            const std::vector<Entity*>& entities) {
+void FragmentManager::checkFragmentCollisions(const Map* map, const SpatialHash* entityHash) {
     for (auto& fragment : fragments) {
         if (fragment && fragment->isActive()) {
-            // 先检查地形碰撞
-            if (fragment->checkTerrainCollision(terrainColliders)) {
-                continue; // 如果撞到地形，就不再检查实体碰撞
-            }
-            
-            // 检查实体碰撞
-            fragment->checkEntityCollision(entities);
+            // 扫掠本帧移动线段，地形与实体按命中先后处理
+            fragment->sweep(map, entityHash, entityQueryBuffer);
         }
     }
 }
@@ -9,11 +9,14 @@
 #include <vector>
 
 class Entity; // 前向声明
+class Map;
+class SpatialHash;
 
 // 弹片类
 class Fragment {
 private:
     float x, y;                      // 当前位置
+    float prevX, prevY;              // 上一帧位置（用于线段扫掠）
     float startX, startY;            // 起始位置
     float dirX, dirY;                // 飞行方向
     float speed;                     // 飞行速度
@@ -49,9 +52,8 @@ public:
     // 渲染弹片
     void render(SDL_Renderer* renderer, int cameraX, int cameraY);
     
-    // 碰撞检测
-    bool checkTerrainCollision(const std::vector<Collider>& terrainColliders);
-    bool checkEntityCollision(const std::vector<Entity*>& entities);
+    // 沿本帧移动线段做网格扫掠：只检测经过方块中的地形和实体，遇到第一个地形命中即停止
+    bool sweep(const Map* map, const SpatialHash* entityHash, std::vector<Entity*>& entityBuffer);
     
     // 获取器
     float getX() const { return x; }
@@ -76,7 +78,6 @@ public:
 private:
     // 内部方法
     void applyPhysics(float deltaTime);
-    bool checkPointCollision(float x, float y, const Collider& collider) const;
     void handleCollision();
 };
 
@@ -84,6 +85,7 @@ private:
 class FragmentManager {
 private:
     std::vector<std::unique_ptr<Fragment>> fragments;
+    std::vector<Entity*> entityQueryBuffer;  // 实体候选复用缓冲区
     static FragmentManager* instance;
     
     FragmentManager() = default;
@@ -108,9 +110,8 @@ public:
     void clearInactiveFragments();
     void clearAllFragments();
     
-    // 碰撞检测
-    void checkFragmentCollisions(const std::vector<Collider>& terrainColliders, 
-                               const std::vector<Entity*>& entities);
+    // 碰撞检测（每个弹片只扫掠本帧移动线段经过的方块）
+    void checkFragmentCollisions(const Map* map, const SpatialHash* entityHash);
     
     // 查询方法
     size_t getActiveFragmentCount() const;
@@ -62,11 +62,16 @@ Game::Game() :
     MAX_TIME_SCALE(10.0f),
     debugMode(false), // 初始化调试模式为关闭状态
     gameUI(std::make_unique<GameUI>()), // 初始化游戏UI
+    entitySpatialHash(std::make_unique<SpatialHash>()),
+    visibilityMap(std::make_unique<VisibilityMap>()),
+    fieldOfView(std::make_unique<FieldOfView>()),
+    lineOfSight(std::make_unique<LineOfSight>()),
     hurtEffectIntensity(0.0f), // 初始化受伤效果
     hurtEffectTime(0.0f)
-    // bullets 向量会自动初始化为空
+    // bullets 子弹池会自动初始化为空
 {
     instance = this;
+    bullets.reserve(256); // 预留子弹池容量，避免交火时扩容
 }
 
 // 实现缩放调整方法
@@ -190,12 +195,14 @@ bool Game::init() {
     gameMap = std::make_unique<Map>(renderer);
     // 初始化地图（生成初始网格）
     gameMap->initialize();
+    lineOfSight->setMap(gameMap.get());
 
     // 初始化寻路系统
     initPathfinder();
 
     // 创建玩家，初始位置为(0,0)，位于(0,0)网格的左下角
     player = std::make_unique<Player>(0.0f, 0.0f);
+    entitySpatialHash->insert(player.get());
 
     // 初始化ItemLoader并加载items.json
     if (!ItemLoader::getInstance()->loadItemsFromFile("jsons/items.json")) {
@@ -941,12 +948,10 @@ void Game::update() {
         // 初始化最小距离为最大值
         pointerToObstacleDistance = std::numeric_limits<float>::max();
         
-        // 检查与所有障碍物的碰撞
-        for (const auto& obstacle : gameMap->getObstacles()) {
-            float distance = obstacle.raycast(playerX, playerY, dirX, dirY);
-            if (distance >= 0 && distance < pointerToObstacleDistance) {
-                pointerToObstacleDistance = distance;
-            }
+        // 检查与地形的碰撞（只遍历激光长度内射线经过的方块）
+        float terrainDistance = gameMap->raycastTerrain(playerX, playerY, dirX, dirY, 1500.0f);
+        if (terrainDistance >= 0) {
+            pointerToObstacleDistance = terrainDistance;
         }
 
         // 检查与所有怪物的碰撞
@@ -970,23 +975,48 @@ void Game::update() {
     // 移除已死亡的丧尸（丧尸死亡后可以立即移除）
     zombies.erase(
         std::remove_if(zombies.begin(), zombies.end(),
-            [](const std::unique_ptr<Zombie>& zombie) {
-                return zombie->getHealth() <= 0;
+            [this](const std::unique_ptr<Zombie>& zombie) {
+                if (zombie->getHealth() > 0) {
+                    return false;
+                }
+                // 撤销其尚未完成的寻路请求
+                if (pathfinder) {
+                    pathfinder->removeCreature(static_cast<Creature*>(zombie.get()));
+                }
+                return true;
             }),
         zombies.end()
     );
 
+    // 构建本帧实体视图，供丧尸感知和攻击系统共享
+    rebuildEntityFrameView();
+
+    // 开始新一帧的视线检测：清空方块连线缓存并按方块重建烟雾分桶
+    dynamicVisionColliders.clear();
+    appendSmokeVisionColliders(dynamicVisionColliders);
+    lineOfSight->beginFrame(dynamicVisionColliders);
+
+    // 推进流场帧计数，丢弃不再被追击的目标的流场
+    if (flowFields) {
+        flowFields->beginFrame();
+    }
+
+    // 取回上一帧的异步寻路结果，并按离玩家的距离分发本帧的寻路任务
+    if (pathfinder && player) {
+        pathfinder->beginFrame(player->getX(), player->getY());
+    }
+
     // 改进的实体间碰撞检测
     // 使用新的物理系统处理实体间碰撞
     processEntityPhysics();
 
-    // 然后处理玩家与丧尸和生物的碰撞
-    for (auto& zombie : zombies) {
-        player->resolveCollision(zombie.get());
-    }
-
-    for (auto& creature : creatures) {
-        player->resolveCollision(creature.get());
+    // 然后处理玩家与附近丧尸和生物的碰撞
+    if (player) {
+        neighborQueryBuffer.clear();
+        entitySpatialHash->queryNeighbors(player.get(), neighborQueryBuffer);
+        for (Entity* other : neighborQueryBuffer) {
+            player->resolveCollision(other);
+        }
     }
 
     // 更新玩家
@@ -1006,13 +1036,11 @@ void Game::update() {
     // 更新生物
     updateCreatures(adjustedDeltaTime);
 
-    // 更新地图（根据玩家位置动态加载/卸载网格）
-    // 测试期间禁用动态地图系统
-    // gameMap->updatePlayerPosition(player->getX(), player->getY());
+    // 更新地图（根据玩家位置提交后台加载请求、卸载远处网格）
+    gameMap->updatePlayerPosition(player->getX(), player->getY());
     
-    // 处理异步加载队列
-    // 测试期间禁用动态地图加载
-    // gameMap->update();
+    // 接收后台加载完成的网格
+    gameMap->update();
     
     // 更新相机位置（以玩家为中心）
     setCamera(player->getX() - (windowWidth / 2) / zoomLevel, 
@@ -1053,6 +1081,9 @@ void Game::render() {
     // 渲染地图
     gameMap->render(renderer, cameraX, cameraY);
 
+    // 构建本帧视野遮挡缓冲，之后的阴影查询和战争迷雾共用
+    updateVisibilityMap();
+
     // 渲染所有丧尸
     renderZombies();
     
@@ -1265,6 +1296,8 @@ void Game::clean() {
     
     // 清理游戏对象
     player.reset();
+    lineOfSight->setMap(nullptr);
+    flowFields.reset();
     gameMap.reset();
     hud.reset();
     zombies.clear();
@@ -1379,65 +1412,25 @@ void Game::processBullets() {
     // 获取调整后的deltaTime
     float adjustedDeltaTime = getAdjustedDeltaTime();
     
-    // 使用迭代器遍历所有子弹，以便安全删除
-    auto it = bullets.begin();
-    while (it != bullets.end()) {
-        Bullet* bullet = it->get();
-        if (!bullet->isActive()) {
-            // 子弹已失活，删除它
-            it = bullets.erase(it);
-            continue;
-        }
-        
-        // 更新子弹位置，使用调整后的deltaTime
-        bullet->update(adjustedDeltaTime);
-        
-        // 收集所有实体用于碰撞检测
-        std::vector<Entity*> allEntities;
-        allEntities.push_back(player.get());
-        for (auto& zombie : zombies) {
-            allEntities.push_back(zombie.get());
-        }
-        for (auto& creature : creatures) {
-            allEntities.push_back(creature.get());
-        }
-        
-        // 检查与障碍物的碰撞
-        if (bullet->checkObstacleCollisions(gameMap->getObstacles())) {
-            // 子弹已失活，但保留到本帧结束再删除
-            ++it;
-            continue;
-        }
-        
-        // 检查与实体的碰撞
-        bullet->checkEntityCollisions(allEntities);
-        
-        // 移动到下一个子弹
-        ++it;
-    }
+    // 更新子弹位置，并沿本帧移动线段做网格扫掠，只检测经过方块中的地形和实体
+    // 命中或超出射程的子弹立即从子弹池中交换删除
+    bullets.update(adjustedDeltaTime, gameMap.get(), entitySpatialHash.get());
 }
 
 // 添加创建子弹的方法实现
-Bullet* Game::createBullet(float startX, float startY, float dirX, float dirY, float speed, 
+bool Game::createBullet(float startX, float startY, float dirX, float dirY, float speed, 
                           Entity* owner, int damageValue, const std::string& damageType, int penetration, float range) {
-    // 创建新子弹并添加到管理容器中
-    auto bullet = std::make_unique<Bullet>(startX, startY, dirX, dirY, speed, owner, damageValue, damageType, penetration, range);
-    
-    // 获取指针用于返回
-    Bullet* bulletPtr = bullet.get();
-    
-    // 将子弹所有权转移到游戏管理容器
-    bullets.push_back(std::move(bullet));
-    
-    return bulletPtr;
+    // 将新子弹追加到子弹池中
+    bullets.spawn(startX, startY, dirX, dirY, speed, owner, damageValue, damageType, penetration, range);
+    return true;
 }
 
 // 添加渲染所有子弹的方法实现
 void Game::renderBullets() {
-    for (const auto& bullet : bullets) {
+    for (size_t i = 0; i < bullets.size(); ++i) {
         // 检查子弹是否在视觉阴影区域内
-        if (!isInShadow(bullet->getX(), bullet->getY())) {
-            bullet->render(renderer, cameraX, cameraY);
+        if (!isInShadow(bullets.getX(i), bullets.getY(i))) {
+            bullets.renderBullet(renderer, i, cameraX, cameraY);
         }
         // 如果在阴影中，则不渲染（被视觉遮挡隐藏）
     }
@@ -1467,15 +1460,13 @@ void Game::renderColliders() {
     }
     
     // 渲染子弹轨迹（黄色）
-    for (const auto& bullet : bullets) {
-        if (bullet->isActive()) {
-            SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
-            SDL_RenderLine(renderer,
-                static_cast<int>(bullet->getX() - cameraX),
-                static_cast<int>(bullet->getY() - cameraY),
-                static_cast<int>(bullet->getX() - cameraX + bullet->getDirX() * 10),
-                static_cast<int>(bullet->getY() - cameraY + bullet->getDirY() * 10));
-        }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        SDL_RenderLine(renderer,
+            static_cast<int>(bullets.getX(i) - cameraX),
+            static_cast<int>(bullets.getY(i) - cameraY),
+            static_cast<int>(bullets.getX(i) - cameraX + bullets.getDirX(i) * 10),
+            static_cast<int>(bullets.getY(i) - cameraY + bullets.getDirY(i) * 10));
     }
     
     // 渲染地图中的地形碰撞箱（绿色）
@@ -1500,10 +1491,11 @@ void Game::renderColliders() {
     }
     
     // 渲染旧的障碍物碰撞箱（蓝色，用于向后兼容）
-    const std::vector<Collider>& obstacles = gameMap->getObstacles();
     SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-    for (const auto& obstacle : obstacles) {
-        obstacle.render(renderer, cameraX, cameraY);
+    for (const auto& entry : gameMap->getGrids()) {
+        for (const Collider* obstacle : entry.second->getTerrainColliders()) {
+            obstacle->render(renderer, cameraX, cameraY);
+        }
     }
 }
 
@@ -1877,6 +1869,7 @@ void Game::spawnZombie(float x, float y, ZombieType type) {
     }
     
     zombies.push_back(std::make_unique<Zombie>(x, y, type));
+    entitySpatialHash->insert(zombies.back().get());
     // std::cout << "丧尸已生成在位置(" << x << ", " << y << ")" << std::endl;
 }
 
@@ -1887,6 +1880,32 @@ void Game::updateZombies(float deltaTime) {
     }
 }
 
+// 按阵营划分本帧实体，避免每个丧尸/攻击系统各自遍历并复制实体列表
+void Game::rebuildEntityFrameView() {
+    attackableTargets.clear();
+    zombieTargets.clear();
+
+    if (player) {
+        zombieTargets.push_back(player.get());
+    }
+
+    for (const auto& zombie : zombies) {
+        if (zombie->getHealth() > 0) {
+            attackableTargets.push_back(zombie.get());
+        }
+    }
+
+    for (const auto& creature : creatures) {
+        if (!creature->hasFlag(EntityFlag::IS_ZOMBIE)) {
+            zombieTargets.push_back(creature.get());
+        }
+        if (creature->getHealth() > 0 &&
+            (creature->getFaction() == Faction::ENEMY || creature->getFaction() == Faction::HOSTILE)) {
+            attackableTargets.push_back(creature.get());
+        }
+    }
+}
+
 // 渲染所有丧尸
 void Game::renderZombies() {
     for (auto& zombie : zombies) {
@@ -1980,6 +1999,7 @@ void Game::renderCreatures() {
 void Game::initPathfinder() {
     if (gameMap) {
         pathfinder = std::make_unique<CreaturePathfinder>(gameMap.get());
+        flowFields = std::make_unique<FlowFieldService>(gameMap.get());
         std::cout << "寻路系统初始化完成" << std::endl;
     } else {
         std::cerr << "无法初始化寻路系统：地图未创建" << std::endl;
@@ -2163,15 +2183,7 @@ void Game::generateTestTerrain() {
         }
     }
     
-    // 更新地图障碍物列表
-    // 测试期间禁用动态地图更新
-    // gameMap->update();
-    
-    // 手动更新障碍物列表，确保新生成的砖块碰撞箱被包含
-    if (gameMap && testTileCount > 0) {
-        gameMap->forceUpdateObstacles();
-        std::cout << "已更新地图障碍物列表，包含新生成的 " << testTileCount << " 个测试地形块" << std::endl;
-    }
+    // 网格的障碍物在修改后首次访问时按网格重建，不需要手动更新
     
     std::cout << "测试地形生成完成！共生成了 " << testTileCount << " 个测试地形块。" << std::endl;
     std::cout << "  - test_brick (红色砖块): 不可通过的障碍物" << std::endl;
@@ -2195,44 +2207,51 @@ void Game::generateTestTerrain() {
 }
 
 // 物理系统：处理所有实体间的碰撞
+// 使用空间哈希作为宽相位，每个实体只与相邻格子中的实体进行检测
 void Game::processEntityPhysics() {
-    // 收集所有实体
-    std::vector<Entity*> allEntities;
-    
-    // 添加玩家
-    if (player) {
-        allEntities.push_back(player.get());
-    }
+    // 登记尚未加入空间哈希的实体（实体之后在updatePhysics中增量更新）
+    auto registerEntity = [this](Entity* entity) {
+        if (entity && entity->getHealth() > 0 && entity->getSpatialHash() != entitySpatialHash.get()) {
+            entitySpatialHash->insert(entity);
+        }
+    };
     
-    // 添加所有丧尸
+    registerEntity(player.get());
     for (auto& zombie : zombies) {
-        if (zombie && zombie->getHealth() > 0) {
-            allEntities.push_back(zombie.get());
-        }
+        registerEntity(zombie.get());
     }
-    
-    // 添加所有生物
     for (auto& creature : creatures) {
-        if (creature && creature->getHealth() > 0) {
-            allEntities.push_back(creature.get());
-        }
+        registerEntity(creature.get());
     }
     
-    // 处理所有实体间的碰撞
-    for (size_t i = 0; i < allEntities.size(); ++i) {
-        for (size_t j = i + 1; j < allEntities.size(); ++j) {
-            Entity* entity1 = allEntities[i];
-            Entity* entity2 = allEntities[j];
-            
-            if (!entity1 || !entity2) continue;
+    // 对单个实体处理与邻居的碰撞，每对实体只处理一次
+    auto processEntity = [this](Entity* entity) {
+        if (!entity || entity->getHealth() <= 0) return;
+        
+        neighborQueryBuffer.clear();
+        entitySpatialHash->queryNeighbors(entity, neighborQueryBuffer);
+        
+        for (Entity* other : neighborQueryBuffer) {
+            // 按地址排序去重，避免同一对实体被处理两次
+            if (!std::less<Entity*>()(entity, other) || other->getHealth() <= 0) {
+                continue;
+            }
             
             // 检查碰撞
             Entity::CollisionInfo info;
-            if (entity1->checkCollisionWith(entity2, info)) {
+            if (entity->checkCollisionWith(other, info)) {
                 // 处理碰撞分离
-                entity1->separateFromEntity(entity2, info);
+                entity->separateFromEntity(other, info);
             }
         }
+    };
+    
+    processEntity(player.get());
+    for (auto& zombie : zombies) {
+        processEntity(zombie.get());
+    }
+    for (auto& creature : creatures) {
+        processEntity(creature.get());
     }
 }
 
@@ -2899,6 +2918,13 @@ std::vector<Collider*> Game::getAllVisionColliders() const {
     }
     
     // 2. 收集烟雾颗粒的VISION碰撞箱
+    appendSmokeVisionColliders(visionColliders);
+    
+    return visionColliders;
+}
+
+// 收集烟雾颗粒的VISION碰撞箱（追加到out）
+void Game::appendSmokeVisionColliders(std::vector<Collider*>& out) const {
     EventManager& eventManager = EventManager::getInstance();
     auto smokeEvents = eventManager.getPersistentEventsOfType(EventType::SMOKE_CLOUD);
     for (const auto& eventPtr : smokeEvents) {
@@ -2908,308 +2934,132 @@ std::vector<Collider*> Game::getAllVisionColliders() const {
                 auto smokeVisionColliders = smokeEvent->getActiveVisionColliders();
                 for (Collider* collider : smokeVisionColliders) {
                     if (collider && collider->getIsActive()) {
-                        visionColliders.push_back(collider);
+                        out.push_back(collider);
                     }
                 }
             }
         }
     }
+}
+
+// 以玩家为观察者重建本帧的视野（每帧渲染前调用一次）
+// 方块墙体由阴影投射视野处理，烟雾等动态遮挡物写入角度遮挡缓冲
+void Game::updateVisibilityMap() {
+    if (!player) {
+        fieldOfView->clear();
+        visibilityMap->clear();
+        return;
+    }
     
-    return visionColliders;
+    float playerX = player->getX();
+    float playerY = player->getY();
+    
+    // 视野半径覆盖玩家到屏幕最远角的距离
+    float viewWidth = windowWidth / zoomLevel;
+    float viewHeight = windowHeight / zoomLevel;
+    float reachX = std::max(std::abs(cameraX - playerX), std::abs(cameraX + viewWidth - playerX));
+    float reachY = std::max(std::abs(cameraY - playerY), std::abs(cameraY + viewHeight - playerY));
+    int radius = static_cast<int>(std::max(reachX, reachY) / GameConstants::TILE_SIZE) + 2;
+    
+    fieldOfView->compute(gameMap.get(), Map::worldToTileIndex(playerX), Map::worldToTileIndex(playerY), radius);
+    
+    dynamicVisionColliders.clear();
+    appendSmokeVisionColliders(dynamicVisionColliders);
+    visibilityMap->rebuild(playerX, playerY, dynamicVisionColliders);
 }
 
 // 实现战争迷雾渲染方法
 void Game::renderFogOfWar() {
     if (!player) return;
     
-    // 获取玩家位置
-    float playerX = player->getX();
-    float playerY = player->getY();
+    // 设置混合模式以实现半透明效果
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     
-    // 获取所有视觉碰撞箱
-    std::vector<Collider*> visionColliders = getAllVisionColliders();
-    if (visionColliders.empty()) return;
+    // 1. 方块视野：每行连续的不可见方块合并为一个矩形
+    int minTileX = static_cast<int>(cameraX / GameConstants::TILE_SIZE) - 1;
+    int maxTileX = static_cast<int>((cameraX + windowWidth / zoomLevel) / GameConstants::TILE_SIZE) + 1;
+    int minTileY = static_cast<int>(cameraY / GameConstants::TILE_SIZE) - 1;
+    int maxTileY = static_cast<int>((cameraY + windowHeight / zoomLevel) / GameConstants::TILE_SIZE) + 1;
     
-    // 收集所有阴影三角形
-    std::vector<SDL_Vertex> allShadowVertices;
-    std::vector<int> allShadowIndices;
-    int vertexOffset = 0;
+    fogRects.clear();
+    for (int tileY = minTileY; tileY <= maxTileY; ++tileY) {
+        int runStart = minTileX;
+        for (int tileX = minTileX; tileX <= maxTileX + 1; ++tileX) {
+            bool hidden = tileX <= maxTileX && !fieldOfView->isTileVisible(tileX, tileY);
+            if (hidden) continue;
+            if (tileX > runStart) {
+                fogRects.push_back({
+                    GameConstants::tileCoordToWorld(runStart) - cameraX,
+                    GameConstants::tileCoordToWorld(tileY) - cameraY,
+                    static_cast<float>((tileX - runStart) * GameConstants::TILE_SIZE),
+                    static_cast<float>(GameConstants::TILE_SIZE)
+                });
+            }
+            runStart = tileX + 1;
+        }
+    }
     
-    // 获取当前可见屏幕范围
-    float screenLeft = cameraX;
-    float screenRight = cameraX + windowWidth / zoomLevel;
-    float screenTop = cameraY;
-    float screenBottom = cameraY + windowHeight / zoomLevel;
+    if (!fogRects.empty()) {
+        SDL_SetRenderDrawColor(renderer, 64, 64, 64, 102);
+        SDL_RenderFillRects(renderer, fogRects.data(), static_cast<int>(fogRects.size()));
+    }
     
-    // 为每个视觉碰撞箱计算阴影区域
-    for (Collider* collider : visionColliders) {
-        if (!collider || !collider->getIsActive()) continue;
-        
-        // 计算碰撞箱的边界
-        float colliderLeft, colliderRight, colliderTop, colliderBottom;
-        float colliderCenterX, colliderCenterY;
-        
-        if (collider->getType() == ColliderType::CIRCLE) {
-            colliderCenterX = collider->getCircleX();
-            colliderCenterY = collider->getCircleY();
-            float radius = collider->getRadius();
-            colliderLeft = colliderCenterX - radius;
-            colliderRight = colliderCenterX + radius;
-            colliderTop = colliderCenterY - radius;
-            colliderBottom = colliderCenterY + radius;
-        } else {
-            const SDL_FRect& box = collider->getBoxCollider();
-            colliderLeft = box.x;
-            colliderRight = box.x + box.w;
-            colliderTop = box.y;
-            colliderBottom = box.y + box.h;
-            colliderCenterX = box.x + box.w / 2;
-            colliderCenterY = box.y + box.h / 2;
-        }
-        
-        // 检查碰撞箱是否在视野范围内或可能产生阴影
-        if (colliderRight < screenLeft - 500 || colliderLeft > screenRight + 500 ||
-            colliderBottom < screenTop - 500 || colliderTop > screenBottom + 500) {
-            continue; // 太远，跳过
-        }
-        
-        // 计算从玩家到碰撞箱的向量
-        float toColliderX = colliderCenterX - playerX;
-        float toColliderY = colliderCenterY - playerY;
-        float distanceToCollider = std::sqrt(toColliderX * toColliderX + toColliderY * toColliderY);
-        
-        if (distanceToCollider < 32.0f) continue; // 太近，不产生阴影
-        
-        // 计算阴影投射的方向和长度
-        float shadowLength = 800.0f; // 阴影长度
+    // 2. 烟雾等动态遮挡物：每个被遮挡的角度格绘制一个从遮挡物表面向外延伸的四边形
+    if (!visibilityMap->hasOccluders()) {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        return;
+    }
+    
+    const float shadowLength = 800.0f; // 阴影长度
+    const SDL_FColor shadowColor = {0.25f, 0.25f, 0.25f, 0.4f};
+    
+    float originX = visibilityMap->getOriginX() - cameraX;
+    float originY = visibilityMap->getOriginY() - cameraY;
+    float binAngle = visibilityMap->getBinAngle();
+    
+    fogVertices.clear();
+    fogIndices.clear();
+    
+    // 每个被遮挡的角度格绘制一个从遮挡物表面向外延伸的四边形
+    for (int bin = 0; bin < visibilityMap->getBinCount(); ++bin) {
+        float nearDist = visibilityMap->getShadowStart(bin);
+        if (nearDist == std::numeric_limits<float>::max()) continue;
+        float farDist = nearDist + shadowLength;
         
-        // 计算碰撞箱的四个角点（或圆形的切点）
-        std::vector<std::pair<float, float>> shadowPoints;
+        float angle1 = visibilityMap->getBinStartAngle(bin);
+        float angle2 = angle1 + binAngle;
+        float cos1 = std::cos(angle1), sin1 = std::sin(angle1);
+        float cos2 = std::cos(angle2), sin2 = std::sin(angle2);
         
-        if (collider->getType() == ColliderType::CIRCLE) {
-            // 圆形：计算从玩家位置到圆的切线
-            float radius = collider->getRadius();
-            
-            // 计算切线角度
-            if (distanceToCollider > radius) {
-                float tangentAngle = std::asin(radius / distanceToCollider);
-                float baseAngle = std::atan2(toColliderY, toColliderX);
-                
-                // 左切点
-                float leftAngle = baseAngle - tangentAngle;
-                float leftTangentX = colliderCenterX + radius * std::cos(leftAngle + M_PI/2);
-                float leftTangentY = colliderCenterY + radius * std::sin(leftAngle + M_PI/2);
-                
-                // 右切点
-                float rightAngle = baseAngle + tangentAngle;
-                float rightTangentX = colliderCenterX + radius * std::cos(rightAngle - M_PI/2);
-                float rightTangentY = colliderCenterY + radius * std::sin(rightAngle - M_PI/2);
-                
-                shadowPoints.push_back({leftTangentX, leftTangentY});
-                shadowPoints.push_back({rightTangentX, rightTangentY});
-            }
-        } else {
-            // 矩形：使用四个角点
-            shadowPoints.push_back({colliderLeft, colliderTop});
-            shadowPoints.push_back({colliderRight, colliderTop});
-            shadowPoints.push_back({colliderRight, colliderBottom});
-            shadowPoints.push_back({colliderLeft, colliderBottom});
-        }
+        int base = static_cast<int>(fogVertices.size());
+        fogVertices.push_back({{originX + cos1 * nearDist, originY + sin1 * nearDist}, shadowColor, {0, 0}});
+        fogVertices.push_back({{originX + cos2 * nearDist, originY + sin2 * nearDist}, shadowColor, {0, 0}});
+        fogVertices.push_back({{originX + cos2 * farDist, originY + sin2 * farDist}, shadowColor, {0, 0}});
+        fogVertices.push_back({{originX + cos1 * farDist, originY + sin1 * farDist}, shadowColor, {0, 0}});
         
-        // 收集阴影三角形顶点
-        if (!shadowPoints.empty()) {
-            for (size_t i = 0; i < shadowPoints.size(); ++i) {
-                float point1X = shadowPoints[i].first;
-                float point1Y = shadowPoints[i].second;
-                
-                size_t nextIndex = (i + 1) % shadowPoints.size();
-                float point2X = shadowPoints[nextIndex].first;
-                float point2Y = shadowPoints[nextIndex].second;
-                
-                // 计算阴影投射的远端点
-                float shadowDir1X = point1X - playerX;
-                float shadowDir1Y = point1Y - playerY;
-                float shadowDist1 = std::sqrt(shadowDir1X * shadowDir1X + shadowDir1Y * shadowDir1Y);
-                if (shadowDist1 > 0) {
-                    shadowDir1X = (shadowDir1X / shadowDist1) * shadowLength;
-                    shadowDir1Y = (shadowDir1Y / shadowDist1) * shadowLength;
-                }
-                
-                float shadowDir2X = point2X - playerX;
-                float shadowDir2Y = point2Y - playerY;
-                float shadowDist2 = std::sqrt(shadowDir2X * shadowDir2X + shadowDir2Y * shadowDir2Y);
-                if (shadowDist2 > 0) {
-                    shadowDir2X = (shadowDir2X / shadowDist2) * shadowLength;
-                    shadowDir2Y = (shadowDir2Y / shadowDist2) * shadowLength;
-                }
-                
-                float farPoint1X = point1X + shadowDir1X;
-                float farPoint1Y = point1Y + shadowDir1Y;
-                float farPoint2X = point2X + shadowDir2X;
-                float farPoint2Y = point2Y + shadowDir2Y;
-                
-                // 转换为屏幕坐标
-                float screenPoint1X = point1X - cameraX;
-                float screenPoint1Y = point1Y - cameraY;
-                float screenPoint2X = point2X - cameraX;
-                float screenPoint2Y = point2Y - cameraY;
-                float screenFarPoint1X = farPoint1X - cameraX;
-                float screenFarPoint1Y = farPoint1Y - cameraY;
-                float screenFarPoint2X = farPoint2X - cameraX;
-                float screenFarPoint2Y = farPoint2Y - cameraY;
-                
-                // 添加阴影四边形的顶点（使用两个三角形）
-                // 三角形1: point1 -> point2 -> farPoint2
-                allShadowVertices.push_back({{screenPoint1X, screenPoint1Y}, {0.25f, 0.25f, 0.25f, 0.06f}, {0, 0}});
-                allShadowVertices.push_back({{screenPoint2X, screenPoint2Y}, {0.25f, 0.25f, 0.25f, 0.06f}, {0, 0}});
-                allShadowVertices.push_back({{screenFarPoint2X, screenFarPoint2Y}, {0.25f, 0.25f, 0.25f, 0.06f}, {0, 0}});
-                
-                allShadowIndices.push_back(vertexOffset);
-                allShadowIndices.push_back(vertexOffset + 1);
-                allShadowIndices.push_back(vertexOffset + 2);
-                vertexOffset += 3;
-                
-                // 三角形2: point1 -> farPoint2 -> farPoint1
-                allShadowVertices.push_back({{screenPoint1X, screenPoint1Y}, {0.25f, 0.25f, 0.25f, 0.06f}, {0, 0}});
-                allShadowVertices.push_back({{screenFarPoint2X, screenFarPoint2Y}, {0.25f, 0.25f, 0.25f, 0.06f}, {0, 0}});
-                allShadowVertices.push_back({{screenFarPoint1X, screenFarPoint1Y}, {0.25f, 0.25f, 0.25f, 0.06f}, {0, 0}});
-                
-                allShadowIndices.push_back(vertexOffset);
-                allShadowIndices.push_back(vertexOffset + 1);
-                allShadowIndices.push_back(vertexOffset + 2);
-                vertexOffset += 3;
-            }
-        }
+        // 两个三角形：近1 -> 近2 -> 远2，近1 -> 远2 -> 远1
+        fogIndices.push_back(base);
+        fogIndices.push_back(base + 1);
+        fogIndices.push_back(base + 2);
+        fogIndices.push_back(base);
+        fogIndices.push_back(base + 2);
+        fogIndices.push_back(base + 3);
     }
     
     // 如果有阴影区域，统一渲染所有阴影
-    if (!allShadowVertices.empty()) {
-        // 设置混合模式以实现半透明效果
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-        
+    if (!fogVertices.empty()) {
         // 一次性渲染所有阴影几何体
         SDL_RenderGeometry(renderer, nullptr, 
-                          allShadowVertices.data(), static_cast<int>(allShadowVertices.size()),
-                          allShadowIndices.data(), static_cast<int>(allShadowIndices.size()));
-        
-        // 恢复默认混合模式
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+                          fogVertices.data(), static_cast<int>(fogVertices.size()),
+                          fogIndices.data(), static_cast<int>(fogIndices.size()));
     }
+    
+    // 恢复默认混合模式
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 }
 
-// 检查点是否在视觉碰撞箱的阴影区域内
+// 检查点是否在视觉碰撞箱的阴影区域内（查询本帧的方块视野和动态遮挡缓冲）
 bool Game::isInShadow(float x, float y) const {
     if (!player) return false;
-    
-    // 获取玩家位置
-    float playerX = player->getX();
-    float playerY = player->getY();
-    
-    // 获取所有视觉碰撞箱
-    std::vector<Collider*> visionColliders = getAllVisionColliders();
-    if (visionColliders.empty()) return false;
-    
-    for (Collider* collider : visionColliders) {
-        if (!collider || !collider->getIsActive()) continue;
-        
-        // 计算碰撞箱的中心和边界
-        float colliderCenterX, colliderCenterY;
-        float colliderLeft, colliderRight, colliderTop, colliderBottom;
-        
-        if (collider->getType() == ColliderType::CIRCLE) {
-            colliderCenterX = collider->getCircleX();
-            colliderCenterY = collider->getCircleY();
-            float radius = collider->getRadius();
-            colliderLeft = colliderCenterX - radius;
-            colliderRight = colliderCenterX + radius;
-            colliderTop = colliderCenterY - radius;
-            colliderBottom = colliderCenterY + radius;
-        } else {
-            const SDL_FRect& box = collider->getBoxCollider();
-            colliderLeft = box.x;
-            colliderRight = box.x + box.w;
-            colliderTop = box.y;
-            colliderBottom = box.y + box.h;
-            colliderCenterX = box.x + box.w / 2;
-            colliderCenterY = box.y + box.h / 2;
-        }
-        
-        // 计算从玩家到碰撞箱的向量
-        float toColliderX = colliderCenterX - playerX;
-        float toColliderY = colliderCenterY - playerY;
-        float distanceToCollider = std::sqrt(toColliderX * toColliderX + toColliderY * toColliderY);
-        
-        if (distanceToCollider < 32.0f) continue; // 太近，不产生阴影
-        
-        // 计算从玩家到目标点的向量
-        float toTargetX = x - playerX;
-        float toTargetY = y - playerY;
-        float distanceToTarget = std::sqrt(toTargetX * toTargetX + toTargetY * toTargetY);
-        
-        // 如果目标点比碰撞箱更近，不可能在阴影中
-        if (distanceToTarget < distanceToCollider) continue;
-        
-        // 检查目标点是否在碰撞箱产生的阴影扇形区域内
-        bool inShadow = false;
-        
-        if (collider->getType() == ColliderType::CIRCLE) {
-            // 圆形碰撞箱：检查是否在切线形成的阴影扇形内
-            float radius = collider->getRadius();
-            
-            if (distanceToCollider > radius) {
-                // 计算切线角度
-                float tangentAngle = std::asin(radius / distanceToCollider);
-                float baseAngle = std::atan2(toColliderY, toColliderX);
-                float targetAngle = std::atan2(toTargetY, toTargetX);
-                
-                // 计算角度差（处理角度环绕）
-                float angleDiff = targetAngle - baseAngle;
-                while (angleDiff > M_PI) angleDiff -= 2 * M_PI;
-                while (angleDiff < -M_PI) angleDiff += 2 * M_PI;
-                
-                // 检查是否在阴影扇形内
-                if (std::abs(angleDiff) <= tangentAngle) {
-                    inShadow = true;
-                }
-            }
-        } else {
-            // 矩形碰撞箱：检查是否在四个角点形成的阴影区域内
-            std::vector<std::pair<float, float>> corners = {
-                {colliderLeft, colliderTop},
-                {colliderRight, colliderTop},
-                {colliderRight, colliderBottom},
-                {colliderLeft, colliderBottom}
-            };
-            
-            // 计算目标点相对于玩家的角度
-            float targetAngle = std::atan2(toTargetY, toTargetX);
-            
-            // 计算矩形四个角相对于玩家的角度范围
-            float minAngle = 2 * M_PI, maxAngle = -2 * M_PI;
-            for (const auto& corner : corners) {
-                float cornerAngle = std::atan2(corner.second - playerY, corner.first - playerX);
-                if (cornerAngle < minAngle) minAngle = cornerAngle;
-                if (cornerAngle > maxAngle) maxAngle = cornerAngle;
-            }
-            
-            // 处理角度环绕问题
-            if (maxAngle - minAngle > M_PI) {
-                // 跨越180度边界的情况
-                if (targetAngle >= minAngle || targetAngle <= maxAngle - 2 * M_PI) {
-                    inShadow = true;
-                }
-            } else {
-                // 正常情况
-                if (targetAngle >= minAngle && targetAngle <= maxAngle) {
-                    inShadow = true;
-                }
-            }
-        }
-        
-        if (inShadow) {
-            return true; // 在任何一个阴影中就返回true
-        }
-    }
-    
-    return false; // 不在任何阴影中
+    return !fieldOfView->isPointVisible(x, y) || visibilityMap->isOccluded(x, y);
 }
\ No newline at end of file
@@ -22,6 +22,11 @@
 #include "DamageNumber.h" // 添加伤害数字头文件
 #include "EventManager.h" // 添加事件管理器头文件
 #include "Fragment.h" // 添加弹片系统头文件
+#include "SpatialHash.h" // 实体空间哈希（宽相位碰撞检测）
+#include "VisibilityMap.h" // 视野遮挡缓冲
+#include "FieldOfView.h" // 方块阴影投射视野
+#include "LineOfSight.h" // 视线检测
+#include "FlowField.h" // 共享流场
 
 // 前向声明
 class Player;
@@ -72,7 +77,7 @@ private:
     const float MAX_TIME_SCALE;
     
     // 添加子弹管理容器
-    std::vector<std::unique_ptr<Bullet>> bullets; // 游戏管理的所有子弹
+    BulletPool bullets; // 游戏管理的所有子弹（SoA子弹池）
 
     // 添加调试模式变量
     bool debugMode;
@@ -92,6 +97,26 @@ private:
 
     // 添加寻路管理器
     std::unique_ptr<CreaturePathfinder> pathfinder;
+    std::unique_ptr<FlowFieldService> flowFields; // 追击同一目标的生物共享的流场
+
+    // 实体空间哈希（宽相位碰撞检测，实体在updatePhysics中增量更新）
+    std::unique_ptr<SpatialHash> entitySpatialHash;
+    std::vector<Entity*> neighborQueryBuffer; // 邻居查询复用缓冲区
+
+    // 每帧实体视图（按阵营划分）：移除死亡丧尸后构建一次，供攻击系统和丧尸感知共享
+    // 丧尸只在update中统一移除，因此视图中的指针在下一次重建前始终有效
+    std::vector<Entity*> attackableTargets;   // 攻击系统可选目标：丧尸和敌对生物
+    std::vector<Entity*> zombieTargets;       // 丧尸可追击的目标：玩家和非丧尸生物
+    void rebuildEntityFrameView();
+
+    // 视野：每帧渲染前以玩家为原点构建一次，供isInShadow和战争迷雾共用
+    std::unique_ptr<VisibilityMap> visibilityMap;   // 烟雾等动态遮挡物的角度遮挡缓冲
+    std::unique_ptr<FieldOfView> fieldOfView;       // 方块墙体的阴影投射视野
+    std::vector<Collider*> dynamicVisionColliders;  // 动态遮挡物复用缓冲区
+    std::unique_ptr<LineOfSight> lineOfSight;       // 生物视线检测（方块连线按帧缓存）
+    std::vector<SDL_FRect> fogRects;          // 战争迷雾方块矩形复用缓冲区
+    std::vector<SDL_Vertex> fogVertices;      // 战争迷雾顶点复用缓冲区
+    std::vector<int> fogIndices;              // 战争迷雾索引复用缓冲区
 
     // 添加伤害数字管理
     std::vector<std::unique_ptr<DamageNumber>> damageNumbers; // 所有伤害数字
@@ -158,8 +183,8 @@ public:
     // 修改子弹处理方法
     void processBullets();
     
-    // 添加创建子弹的方法
-    Bullet* createBullet(float startX, float startY, float dirX, float dirY, float speed, 
+    // 添加创建子弹的方法（子弹由子弹池管理，不返回指针）
+    bool createBullet(float startX, float startY, float dirX, float dirY, float speed, 
                         Entity* owner, int damageValue, const std::string& damageType = "shooting", int penetration = -1, float range = 1000.0f);
     
     // 添加创建物品掉落的方法
@@ -194,14 +219,29 @@ public:
     // 获取玩家指针
     Player* getPlayer() const { return player.get(); }
 
+    // 获取实体空间哈希
+    SpatialHash* getEntitySpatialHash() const { return entitySpatialHash.get(); }
+
+    // 获取本帧实体视图（构建时存活，使用时仍需检查生命值）
+    const std::vector<Entity*>& getAttackableTargets() const { return attackableTargets; }
+    const std::vector<Entity*>& getZombieTargets() const { return zombieTargets; }
+
     // 新增：获取所有视觉碰撞箱（统一接口）
     std::vector<Collider*> getAllVisionColliders() const;
+    void appendSmokeVisionColliders(std::vector<Collider*>& out) const; // 只收集烟雾颗粒的视觉碰撞箱
+
+    // 获取本帧玩家视野（方块可见性，可供AI复用）
+    const FieldOfView* getFieldOfView() const { return fieldOfView.get(); }
+
+    // 获取视线检测服务
+    LineOfSight* getLineOfSight() const { return lineOfSight.get(); }
 
     // 调试模式相关方法
     void toggleDebugMode() { debugMode = !debugMode; }
     bool isDebugMode() const { return debugMode; }
     void renderColliders(); // 渲染所有碰撞箱
     void renderSmokeEffects(); // 渲染烟雾效果
+    void updateVisibilityMap(); // 重建本帧视野遮挡缓冲
     void renderFogOfWar(); // 渲染战争迷雾效果（被视觉碰撞箱遮挡的区域）
     bool isInShadow(float x, float y) const; // 检查点是否在视觉碰撞箱的阴影区域内
     
@@ -222,6 +262,7 @@ public:
     
     // 添加寻路管理器相关方法
     CreaturePathfinder* getPathfinder() const { return pathfinder.get(); }
+    FlowFieldService* getFlowFields() const { return flowFields.get(); }
     void initPathfinder(); // 初始化寻路系统
     
     // 调试：渲染生物路径
@@ -1,20 +1,70 @@
 #include "Grid.h"
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+
+std::atomic<uint32_t> Grid::nextRevision{1};
 
 Grid::Grid(const std::string& gridName, int posX, int posY, int gSize, int tSize)
     : name(gridName),
       x(posX),
       y(posY),
       gridSize(gSize),
-      tileSize(tSize) {
-    // 初始化方块数组 - 修复unique_ptr拷贝构造函数错误
-    tiles.resize(gridSize);
-    for (auto& row : tiles) {
-        row.resize(gridSize);
+      tileSize(tSize),
+      revision(nextRevision++),
+      terrainCollidersRevision(0),
+      bakedTexture(nullptr),
+      bakedRevision(0),
+      bakedLastUsedFrame(0) {
+    // 初始化方块数组（全部为空方块，之后不再扩容，方块地址保持稳定）
+    tiles.resize(gridSize * gridSize);
+    opacityBits.assign((gridSize * gridSize + 63) / 64, 0);
+    walkableBits.assign((gridSize * gridSize + 63) / 64, ~uint64_t(0));
+    moveCostBytes.assign(gridSize * gridSize, static_cast<uint8_t>(100.0f / MOVE_COST_STEP));
+}
+
+Grid::~Grid() {
+    if (bakedTexture) {
+        SDL_DestroyTexture(bakedTexture);
     }
 }
 
+void Grid::updateTileBits(int index) {
+    const Tile& tile = tiles[index];
+    uint64_t mask = uint64_t(1) << (index & 63);
+    
+    // 空格子透明且可通行
+    if (tile.isEmpty() || tile.getIsTransparent()) {
+        opacityBits[index >> 6] &= ~mask;
+    } else {
+        opacityBits[index >> 6] |= mask;
+    }
+    
+    if (!tile.isEmpty() && tile.hasColliderWithPurpose(ColliderPurpose::TERRAIN)) {
+        walkableBits[index >> 6] &= ~mask;
+    } else {
+        walkableBits[index >> 6] |= mask;
+    }
+    
+    float cost = tile.isEmpty() ? 100.0f : tile.getMoveCost();
+    float steps = std::round(cost / MOVE_COST_STEP);
+    moveCostBytes[index] = static_cast<uint8_t>(std::min(255.0f, std::max(1.0f, steps)));
+}
+
+void Grid::refreshTile(int gridX, int gridY) {
+    if (gridX < 0 || gridX >= gridSize || gridY < 0 || gridY >= gridSize) return;
+    
+    updateTileBits(gridY * gridSize + gridX);
+    markModified();
+}
+
 void Grid::addTile(std::unique_ptr<Tile> tile, int gridX, int gridY) {
+    if (tile) {
+        addTile(std::move(*tile), gridX, gridY);
+    }
+}
+
+void Grid::addTile(Tile&& tile, int gridX, int gridY) {
     // 检查坐标是否有效
     if (gridX < 0 || gridX >= gridSize || gridY < 0 || gridY >= gridSize) {
         std::cerr << "无效的网格坐标: (" << gridX << ", " << gridY << ")" << std::endl;
@@ -26,10 +76,13 @@ void Grid::addTile(std::unique_ptr<Tile> tile, int gridX, int gridY) {
     int worldY = y + gridY * tileSize;
     
     // 设置方块位置
-    tile->setPosition(worldX, worldY);
+    tile.setPosition(worldX, worldY);
     
-    // 添加方块到网格
-    tiles[gridY][gridX] = std::move(tile);
+    // 添加方块到网格，并更新不透明/可通行位图和耗时数组
+    int bit = gridY * gridSize + gridX;
+    tiles[bit] = std::move(tile);
+    updateTileBits(bit);
+    markModified();
 }
 
 Tile* Grid::getTile(int gridX, int gridY) const {
@@ -38,7 +91,9 @@ Tile* Grid::getTile(int gridX, int gridY) const {
         return nullptr;
     }
     
-    return tiles[gridY][gridX].get();
+    // 网格持有方块，调用方可以修改方块状态（与地图的getTileAt一致）
+    const Tile& tile = tiles[gridY * gridSize + gridX];
+    return tile.isEmpty() ? nullptr : const_cast<Tile*>(&tile);
 }
 
 void Grid::initializeTextures(SDL_Renderer* renderer) {
@@ -49,14 +104,12 @@ void Grid::initializeTextures(SDL_Renderer* renderer) {
     int totalTiles = 0;
     
     // 单线程初始化所有方块的纹理
-    for (int y = 0; y < gridSize; ++y) {
-        for (int x = 0; x < gridSize; ++x) {
-            if (tiles[y][x]) {
-                totalTiles++;
-                // 确保方块的纹理被初始化
-                if (tiles[y][x]->initializeTexture(renderer)) {
-                    initializedCount++;
-                }
+    for (Tile& tile : tiles) {
+        if (!tile.isEmpty()) {
+            totalTiles++;
+            // 确保方块的纹理被初始化
+            if (tile.initializeTexture(renderer)) {
+                initializedCount++;
             }
         }
     }
@@ -66,34 +119,96 @@ void Grid::initializeTextures(SDL_Renderer* renderer) {
 
 void Grid::render(SDL_Renderer* renderer, int cameraX, int cameraY) {
     // 渲染所有方块
-    for (int y = 0; y < gridSize; ++y) {
-        for (int x = 0; x < gridSize; ++x) {
-            if (tiles[y][x]) {
-                tiles[y][x]->render(renderer, cameraX, cameraY);
-            }
+    for (Tile& tile : tiles) {
+        if (!tile.isEmpty()) {
+            tile.render(renderer, cameraX, cameraY);
         }
     }
 }
 
-std::vector<Collider> Grid::getColliders() const {
-    std::vector<Collider> colliders;
-    
-    // 收集所有有碰撞的方块的碰撞箱
-    for (int y = 0; y < gridSize; ++y) {
-        for (int x = 0; x < gridSize; ++x) {
-            if (tiles[y][x] && tiles[y][x]->getHasCollision()) {
-                // 使用新的碰撞箱系统获取地形碰撞箱
-                std::vector<Collider*> terrainColliders = tiles[y][x]->getCollidersByPurpose(ColliderPurpose::TERRAIN);
-                for (const auto& collider : terrainColliders) {
-                    if (collider) {
-                        colliders.push_back(*collider);
-                    }
+bool Grid::renderBaked(SDL_Renderer* renderer, float cameraX, float cameraY, uint32_t frame) {
+    if (!bakedTexture) {
+        int side = gridSize * BAKE_TILE_PIXELS;
+        bakedTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, side, side);
+        if (!bakedTexture) {
+            static bool loggedError = false;
+            if (!loggedError) {
+                std::cerr << "无法创建网格烘焙纹理: " << SDL_GetError() << std::endl;
+                loggedError = true; // 只记录一次，避免日志过多
+            }
+            return false;
+        }
+        SDL_SetTextureBlendMode(bakedTexture, SDL_BLENDMODE_BLEND);
+        bakedRevision = 0;
+    }
+    
+    if (bakedRevision != revision) {
+        // 切换到烘焙纹理绘制所有方块，完成后恢复原渲染目标和缩放
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        float scaleX, scaleY;
+        SDL_GetRenderScale(renderer, &scaleX, &scaleY);
+        
+        SDL_SetRenderTarget(renderer, bakedTexture);
+        SDL_SetRenderScale(renderer, 1.0f, 1.0f);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        
+        for (int tileY = 0; tileY < gridSize; ++tileY) {
+            for (int tileX = 0; tileX < gridSize; ++tileX) {
+                Tile& tile = tiles[tileY * gridSize + tileX];
+                if (!tile.isEmpty()) {
+                    SDL_FRect dstRect = {
+                        static_cast<float>(tileX * BAKE_TILE_PIXELS),
+                        static_cast<float>(tileY * BAKE_TILE_PIXELS),
+                        static_cast<float>(BAKE_TILE_PIXELS),
+                        static_cast<float>(BAKE_TILE_PIXELS)
+                    };
+                    tile.draw(renderer, dstRect);
                 }
             }
         }
+        
+        SDL_SetRenderTarget(renderer, previousTarget);
+        SDL_SetRenderScale(renderer, scaleX, scaleY);
+        bakedRevision = revision;
     }
     
-    return colliders;
+    SDL_FRect dstRect = {
+        static_cast<float>(x) - cameraX,
+        static_cast<float>(y) - cameraY,
+        static_cast<float>(getTotalSize()),
+        static_cast<float>(getTotalSize())
+    };
+    SDL_RenderTexture(renderer, bakedTexture, nullptr, &dstRect);
+    bakedLastUsedFrame = frame;
+    return true;
+}
+
+void Grid::releaseIdleBakedTexture(uint32_t frame, uint32_t idleFrames) {
+    if (bakedTexture && frame - bakedLastUsedFrame > idleFrames) {
+        SDL_DestroyTexture(bakedTexture);
+        bakedTexture = nullptr;
+    }
+}
+
+const std::vector<const Collider*>& Grid::getTerrainColliders() const {
+    if (terrainCollidersRevision == revision) {
+        return terrainColliders;
+    }
+    
+    // 收集所有有碰撞的方块的地形碰撞箱（只保存指针，不拷贝碰撞箱）
+    terrainColliders.clear();
+    for (const Tile& tile : tiles) {
+        if (!tile.isEmpty() && tile.getHasCollision()) {
+            for (const auto& collider : tile.getColliders()) {
+                if (collider && collider->getPurpose() == ColliderPurpose::TERRAIN) {
+                    terrainColliders.push_back(collider.get());
+                }
+            }
+        }
+    }
+    terrainCollidersRevision = revision;
+    return terrainColliders;
 }
 
 void Grid::setPosition(int posX, int posY) {
@@ -106,13 +221,9 @@ void Grid::setPosition(int posX, int posY) {
     y = posY;
     
     // 更新所有方块的位置
-    for (int y = 0; y < gridSize; ++y) {
-        for (int x = 0; x < gridSize; ++x) {
-            if (tiles[y][x]) {
-                int tileX = tiles[y][x]->getX() + offsetX;
-                int tileY = tiles[y][x]->getY() + offsetY;
-                tiles[y][x]->setPosition(tileX, tileY);
-            }
+    for (Tile& tile : tiles) {
+        if (!tile.isEmpty()) {
+            tile.setPosition(tile.getX() + offsetX, tile.getY() + offsetY);
         }
     }
 }
@@ -128,7 +239,8 @@ std::unique_ptr<Grid> Grid::createGrasslandGrid(int posX, int posY, int gSize, i
         for (int x = 0; x < gSize; ++x) {
             // 创建草地方块
             // 参数：名称、贴图路径、碰撞、透视、可破坏、位置X、位置Y、大小
-            auto tile = std::make_unique<Tile>(
+            // 同名方块共享方块类型，这里只创建每格的状态
+            grid->addTile(Tile(
                 "Grassland",
                 "assets/tiles/grassland.bmp",
                 false,  // 没有碰撞箱
@@ -136,10 +248,7 @@ std::unique_ptr<Grid> Grid::createGrasslandGrid(int posX, int posY, int gSize, i
                 false,  // 不可破坏
                 0, 0,   // 位置会在addTile中设置
                 tSize
-            );
-            
-            // 添加到网格
-            grid->addTile(std::move(tile), x, y);
+            ), x, y);
         }
     }
     
@@ -6,29 +6,95 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <atomic>
 #include "Tile.h"
 #include "Constants.h"
 
 class Grid {
 private:
     std::string name;                              // 网格名称
-    std::vector<std::vector<std::unique_ptr<Tile>>> tiles; // 16x16的方块数组
+    std::vector<Tile> tiles;                       // 方块数组（按行连续存放，空格子为空方块）
     int x, y;                                      // 网格位置（世界坐标）
     int gridSize;                                  // 网格大小（默认16）
     int tileSize;                                  // 方块大小（默认64像素）
+    std::vector<uint64_t> opacityBits;             // 方块不透明位图（按行打包，addTile时更新）
+    std::vector<uint64_t> walkableBits;            // 方块可通行位图（没有地形碰撞箱为1，空格子可通行）
+    std::vector<uint8_t> moveCostBytes;            // 量化的移动耗时（单位为MOVE_COST_STEP）
+    uint32_t revision;                             // 修订号，方块变化时取新值（所有网格间唯一）
+    mutable std::vector<const Collider*> terrainColliders; // 地形碰撞箱缓存（指向方块持有的碰撞箱）
+    mutable uint32_t terrainCollidersRevision;     // 缓存对应的修订号（0表示尚未构建）
+    SDL_Texture* bakedTexture;                     // 预烘焙的静态层纹理（所有方块绘制到一张渲染目标上）
+    uint32_t bakedRevision;                        // 烘焙时的修订号，不同时重新烘焙
+    uint32_t bakedLastUsedFrame;                   // 最近一次绘制烘焙纹理的帧序号
+    
+    static std::atomic<uint32_t> nextRevision;
+    
+    // 重新计算方块在不透明/可通行位图和耗时数组中的值
+    void updateTileBits(int index);
 
 public:
     // 构造函数
     Grid(const std::string& gridName, int posX, int posY, int gSize = GameConstants::DEFAULT_GRID_SIZE, int tSize = GameConstants::TILE_SIZE);
+    ~Grid();
     
-    // 添加方块到网格
+    // 持有烘焙纹理，不允许拷贝
+    Grid(const Grid&) = delete;
+    Grid& operator=(const Grid&) = delete;
+    
+    // 添加方块到网格（方块被移动到网格的连续数组中）
+    void addTile(Tile&& tile, int gridX, int gridY);
     void addTile(std::unique_ptr<Tile> tile, int gridX, int gridY);
     
     // 获取网格中的方块
     Tile* getTile(int gridX, int gridY) const;
     
-    // 获取网格中所有方块的二维数组（用于保存和加载）
-    const std::vector<std::vector<std::unique_ptr<Tile>>>& getTiles() const { return tiles; }
+    // 查询方块是否不透明（阻挡视线），越界或空方块视为透明
+    bool isTileOpaque(int gridX, int gridY) const {
+        if (gridX < 0 || gridX >= gridSize || gridY < 0 || gridY >= gridSize) return false;
+        int bit = gridY * gridSize + gridX;
+        return (opacityBits[bit >> 6] >> (bit & 63)) & 1u;
+    }
+    
+    // 查询方块是否可通行（没有地形碰撞箱），越界或空方块视为可通行
+    bool isTileWalkable(int gridX, int gridY) const {
+        if (gridX < 0 || gridX >= gridSize || gridY < 0 || gridY >= gridSize) return true;
+        int bit = gridY * gridSize + gridX;
+        return (walkableBits[bit >> 6] >> (bit & 63)) & 1u;
+    }
+    
+    // 一行方块的可通行位（第i位对应gridX=i，gridSize及以上的位为1，越界行全部为1）
+    // 要求gridSize不超过64，路径平滑按行批量读取可通行性
+    uint64_t getWalkableRow(int gridY) const {
+        if (gridY < 0 || gridY >= gridSize) return ~uint64_t(0);
+        int bit = gridY * gridSize;
+        int shift = bit & 63;
+        uint64_t row = walkableBits[bit >> 6] >> shift;
+        if (shift + gridSize > 64) {
+            row |= walkableBits[(bit >> 6) + 1] << (64 - shift);
+        }
+        return gridSize < 64 ? row | (~uint64_t(0) << gridSize) : row;
+    }
+    
+    // 查询方块的移动耗时（以100为基准，按MOVE_COST_STEP量化），越界或空方块为100
+    float getTileMoveCost(int gridX, int gridY) const {
+        if (gridX < 0 || gridX >= gridSize || gridY < 0 || gridY >= gridSize) return 100.0f;
+        return moveCostBytes[gridY * gridSize + gridX] * MOVE_COST_STEP;
+    }
+    
+    // 移动耗时的量化步长：常用耗时（25、50、100、150、200…）可精确表示，上限255*5
+    static constexpr float MOVE_COST_STEP = 5.0f;
+    
+    // 直接修改方块（碰撞箱、透明度、移动耗时）后调用：刷新位图并更新修订号
+    void refreshTile(int gridX, int gridY);
+    
+    // 修订号：依赖方块内容的缓存（如分层寻路的入口图）据此判断是否需要重建
+    // 直接修改方块（如改变碰撞箱）后需调用markModified
+    uint32_t getRevision() const { return revision; }
+    void markModified() { revision = nextRevision++; }
+    
+    // 获取网格中所有方块（按行连续存放，下标为 gridY * gridSize + gridX）
+    const std::vector<Tile>& getTiles() const { return tiles; }
     
     // 初始化所有方块的贴图
     void initializeTextures(SDL_Renderer* renderer);
@@ -36,6 +102,16 @@ public:
     // 渲染网格
     void render(SDL_Renderer* renderer, int cameraX, int cameraY);
     
+    // 烘焙纹理中每个方块的边长（像素）：缩放不超过0.5时不低于屏幕上的方块大小
+    static constexpr int BAKE_TILE_PIXELS = 32;
+    
+    // 用预烘焙的纹理整块绘制网格（一次绘制调用），方块修改后首次绘制时重新烘焙
+    // frame为当前帧序号，用于释放长期未使用的纹理；无法创建渲染目标时返回false（调用方退回逐方块绘制）
+    bool renderBaked(SDL_Renderer* renderer, float cameraX, float cameraY, uint32_t frame);
+    
+    // 烘焙纹理超过idleFrames帧未使用时释放（只在主线程调用）
+    void releaseIdleBakedTexture(uint32_t frame, uint32_t idleFrames);
+    
     // 获取网格属性
     const std::string& getName() const { return name; }
     int getX() const { return x; }
@@ -44,8 +120,9 @@ public:
     int getTileSize() const { return tileSize; }
     int getTotalSize() const { return gridSize * tileSize; } // 网格总大小（像素）
     
-    // 获取网格中所有方块的碰撞箱
-    std::vector<Collider> getColliders() const;
+    // 网格中所有方块的地形碰撞箱（修订号变化后首次访问时重建，只重建本网格；仅主线程调用）
+    // 返回的指针在下一次修改方块之前有效
+    const std::vector<const Collider*>& getTerrainColliders() const;
     
     // 设置网格位置
     void setPosition(int posX, int posY);
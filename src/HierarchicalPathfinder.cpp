@@ -0,0 +1,441 @@
+#include "HierarchicalPathfinder.h"
+#include "Grid.h"
+#include "Constants.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+namespace {
+    const float INF_COST = std::numeric_limits<float>::max();
+
+    // 相邻网格方向：左、右、上、下
+    const int NEIGHBOR_DIRECTIONS[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+
+    float heuristic(int x1, int y1, int x2, int y2) {
+        float dx = static_cast<float>(x2 - x1);
+        float dy = static_cast<float>(y2 - y1);
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    GridCoord tileToChunk(int tileX, int tileY) {
+        int chunkX, chunkY, localX, localY;
+        Map::splitTileIndex(tileX, chunkX, localX);
+        Map::splitTileIndex(tileY, chunkY, localY);
+        return GridCoord{chunkX, chunkY};
+    }
+
+    PathPoint makePathPoint(const AStar& astar, int tileX, int tileY) {
+        // 方块中心的世界坐标
+        return PathPoint(tileX * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET,
+                         tileY * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET,
+                         astar.getTerrainCost(tileX, tileY) / 100.0f);
+    }
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(Map* gameMap)
+    : map(gameMap), queryId(0) {
+}
+
+bool HierarchicalPathfinder::canPlan(int startX, int startY, int targetX, int targetY) const {
+    if (!map) return false;
+
+    GridCoord startChunk = tileToChunk(startX, startY);
+    GridCoord targetChunk = tileToChunk(targetX, targetY);
+    return map->getGridAtCoord(startChunk.x, startChunk.y) != nullptr &&
+           map->getGridAtCoord(targetChunk.x, targetChunk.y) != nullptr;
+}
+
+void HierarchicalPathfinder::loadChunkCells(const AStar& astar, const GridCoord& chunk) {
+    const int side = GameConstants::MAP_GRID_SIZE;
+    int originX = chunk.x * side;
+    int originY = chunk.y * side;
+
+    cellWalkable.resize(side * side);
+    cellCost.resize(side * side);
+    for (int localY = 0; localY < side; ++localY) {
+        for (int localX = 0; localX < side; ++localX) {
+            int cell = localY * side + localX;
+            cellWalkable[cell] = astar.isWalkable(originX + localX, originY + localY) ? 1 : 0;
+            cellCost[cell] = astar.getTerrainCost(originX + localX, originY + localY) / 100.0f;
+        }
+    }
+}
+
+void HierarchicalPathfinder::runChunkDijkstra(int localX, int localY) {
+    const int side = GameConstants::MAP_GRID_SIZE;
+    cellDistance.assign(side * side, INF_COST);
+    cellParent.assign(side * side, -1);
+    dijkstraHeap.clear();
+
+    int startCell = localY * side + localX;
+    cellDistance[startCell] = 0.0f;
+    dijkstraHeap.emplace_back(0.0f, startCell);
+
+    std::greater<std::pair<float, int>> compare;
+    while (!dijkstraHeap.empty()) {
+        std::pop_heap(dijkstraHeap.begin(), dijkstraHeap.end(), compare);
+        auto [distance, cell] = dijkstraHeap.back();
+        dijkstraHeap.pop_back();
+        if (distance > cellDistance[cell]) {
+            continue; // 过期的堆项
+        }
+
+        int cellX = cell % side;
+        int cellY = cell / side;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0) continue;
+                int nx = cellX + dx;
+                int ny = cellY + dy;
+                if (nx < 0 || ny < 0 || nx >= side || ny >= side) continue;
+
+                int neighbor = ny * side + nx;
+                if (!cellWalkable[neighbor]) continue;
+
+                // 与AStar::getMoveCost一致：目标方块耗时，对角线乘√2
+                float step = cellCost[neighbor] * ((dx != 0 && dy != 0) ? 1.414f : 1.0f);
+                if (distance + step < cellDistance[neighbor]) {
+                    cellDistance[neighbor] = distance + step;
+                    cellParent[neighbor] = cell;
+                    dijkstraHeap.emplace_back(distance + step, neighbor);
+                    std::push_heap(dijkstraHeap.begin(), dijkstraHeap.end(), compare);
+                }
+            }
+        }
+    }
+}
+
+int HierarchicalPathfinder::findPortal(const ChunkGraph& graph, int tileX, int tileY) const {
+    for (size_t i = 0; i < graph.portals.size(); ++i) {
+        if (graph.portals[i].tileX == tileX && graph.portals[i].tileY == tileY) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void HierarchicalPathfinder::buildChunkGraph(const AStar& astar, const GridCoord& chunk, ChunkGraph& graph) {
+    const int side = GameConstants::MAP_GRID_SIZE;
+    int originX = chunk.x * side;
+    int originY = chunk.y * side;
+
+    graph.portals.clear();
+    loadChunkCells(astar, chunk);
+
+    auto addPortal = [&](int localX, int localY) {
+        int tileX = originX + localX;
+        int tileY = originY + localY;
+        if (findPortal(graph, tileX, tileY) < 0) {
+            graph.portals.push_back(Portal{tileX, tileY, {}});
+        }
+    };
+
+    // 沿四条边界查找两侧都可通行的连续段，每段放置入口
+    // 判定条件对边界两侧的网格对称，因此相邻网格在同一位置得到成对的入口
+    for (int direction = 0; direction < 4; ++direction) {
+        int dx = NEIGHBOR_DIRECTIONS[direction][0];
+        int dy = NEIGHBOR_DIRECTIONS[direction][1];
+        int runStart = -1;
+
+        // 边界上第index个方块的网格内坐标
+        auto borderToLocal = [&](int index, int& outX, int& outY) {
+            outX = (dx < 0) ? 0 : (dx > 0) ? side - 1 : index;
+            outY = (dy < 0) ? 0 : (dy > 0) ? side - 1 : index;
+        };
+
+        for (int i = 0; i <= side; ++i) {
+            int localX, localY;
+            borderToLocal(std::min(i, side - 1), localX, localY);
+
+            bool open = i < side &&
+                        cellWalkable[localY * side + localX] &&
+                        astar.isWalkable(originX + localX + dx, originY + localY + dy);
+
+            if (open && runStart < 0) {
+                runStart = i;
+            } else if (!open && runStart >= 0) {
+                int runEnd = i - 1;
+                int px, py;
+                if (runEnd - runStart + 1 < MAX_PORTAL_RUN) {
+                    borderToLocal((runStart + runEnd) / 2, px, py);
+                    addPortal(px, py);
+                } else {
+                    borderToLocal(runStart, px, py);
+                    addPortal(px, py);
+                    borderToLocal(runEnd, px, py);
+                    addPortal(px, py);
+                }
+                runStart = -1;
+            }
+        }
+    }
+
+    // 网格内入口两两之间的最短代价
+    for (size_t i = 0; i < graph.portals.size(); ++i) {
+        Portal& portal = graph.portals[i];
+        runChunkDijkstra(portal.tileX - originX, portal.tileY - originY);
+
+        for (size_t j = 0; j < graph.portals.size(); ++j) {
+            if (i == j) continue;
+            const Portal& other = graph.portals[j];
+            float cost = cellDistance[(other.tileY - originY) * side + (other.tileX - originX)];
+            if (cost < INF_COST) {
+                portal.edges.push_back(PortalEdge{static_cast<int>(j), cost});
+            }
+        }
+    }
+}
+
+const HierarchicalPathfinder::ChunkGraph* HierarchicalPathfinder::getChunkGraph(const AStar& astar, const GridCoord& chunk) {
+    const Grid* grid = map ? map->getGridAtCoord(chunk.x, chunk.y) : nullptr;
+    if (!grid) {
+        chunkGraphs.erase(chunk);
+        return nullptr;
+    }
+
+    ChunkGraph& graph = chunkGraphs[chunk];
+    if (graph.checkedQuery == queryId && graph.grid == grid) {
+        return &graph;
+    }
+    graph.checkedQuery = queryId;
+
+    bool stale = graph.grid != grid || graph.revision != grid->getRevision();
+
+    const Grid* neighbors[4];
+    uint32_t neighborRevisions[4];
+    for (int direction = 0; direction < 4; ++direction) {
+        neighbors[direction] = map->getGridAtCoord(chunk.x + NEIGHBOR_DIRECTIONS[direction][0],
+                                                   chunk.y + NEIGHBOR_DIRECTIONS[direction][1]);
+        neighborRevisions[direction] = neighbors[direction] ? neighbors[direction]->getRevision() : 0;
+        if (graph.neighbors[direction] != neighbors[direction] ||
+            graph.neighborRevisions[direction] != neighborRevisions[direction]) {
+            stale = true;
+        }
+    }
+
+    if (stale) {
+        buildChunkGraph(astar, chunk, graph);
+        graph.grid = grid;
+        graph.revision = grid->getRevision();
+        for (int direction = 0; direction < 4; ++direction) {
+            graph.neighbors[direction] = neighbors[direction];
+            graph.neighborRevisions[direction] = neighborRevisions[direction];
+        }
+    }
+
+    return &graph;
+}
+
+void HierarchicalPathfinder::pruneCache() {
+    for (auto it = chunkGraphs.begin(); it != chunkGraphs.end();) {
+        if (!map || map->getGridAtCoord(it->first.x, it->first.y) != it->second.grid) {
+            it = chunkGraphs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int HierarchicalPathfinder::getOrCreateSearchNode(int tileX, int tileY, const GridCoord& chunk, int portal) {
+    auto result = searchNodeIndex.emplace(makeKey(tileX, tileY), static_cast<int>(searchNodes.size()));
+    if (result.second) {
+        searchNodes.push_back(SearchNode{tileX, tileY, chunk, portal, INF_COST, INF_COST, -1, false});
+    }
+    return result.first->second;
+}
+
+void HierarchicalPathfinder::relaxSearchNode(int index, float gCost, int parent, int targetX, int targetY) {
+    SearchNode& node = searchNodes[index];
+    if (node.closed || gCost >= node.gCost) {
+        return;
+    }
+
+    node.gCost = gCost;
+    node.fCost = gCost + heuristic(node.tileX, node.tileY, targetX, targetY);
+    node.parent = parent;
+    openHeap.emplace_back(node.fCost, index);
+    std::push_heap(openHeap.begin(), openHeap.end(), std::greater<std::pair<float, int>>());
+}
+
+void HierarchicalPathfinder::appendChunkSegment(const AStar& astar, const std::vector<int>& parents,
+                                                const GridCoord& chunk, int endTileX, int endTileY,
+                                                std::vector<PathPoint>& outPath) {
+    const int side = GameConstants::MAP_GRID_SIZE;
+    int originX = chunk.x * side;
+    int originY = chunk.y * side;
+
+    // 从终点沿父方块回溯到Dijkstra的源点（源点已在路径中，不再加入）
+    segmentCells.clear();
+    for (int cell = (endTileY - originY) * side + (endTileX - originX); parents[cell] >= 0; cell = parents[cell]) {
+        segmentCells.push_back(cell);
+    }
+
+    for (auto it = segmentCells.rbegin(); it != segmentCells.rend(); ++it) {
+        outPath.push_back(makePathPoint(astar, originX + *it % side, originY + *it / side));
+    }
+}
+
+PathfindingResult HierarchicalPathfinder::findPath(const PathfindingRequest& request, const AStar& astar,
+                                                   std::vector<PathPoint>& outPath) {
+    outPath.clear();
+
+    if (!astar.isWalkable(request.startX, request.startY)) {
+        return PathfindingResult::START_BLOCKED;
+    }
+    if (!astar.isWalkable(request.targetX, request.targetY)) {
+        return PathfindingResult::TARGET_BLOCKED;
+    }
+
+    if (chunkGraphs.size() > MAX_CACHED_CHUNKS) {
+        pruneCache();
+    }
+    // 0保留给新建的入口图，保证首次访问时一定校验
+    if (++queryId == 0) {
+        queryId = 1;
+    }
+
+    const int side = GameConstants::MAP_GRID_SIZE;
+    GridCoord startChunk = tileToChunk(request.startX, request.startY);
+    GridCoord targetChunk = tileToChunk(request.targetX, request.targetY);
+    const ChunkGraph* startGraph = getChunkGraph(astar, startChunk);
+    const ChunkGraph* targetGraph = getChunkGraph(astar, targetChunk);
+    if (!startGraph || !targetGraph) {
+        return PathfindingResult::NO_PATH;
+    }
+
+    // 起点接入：起点网格内到各入口的代价
+    loadChunkCells(astar, startChunk);
+    runChunkDijkstra(request.startX - startChunk.x * side, request.startY - startChunk.y * side);
+    startCellParent = cellParent;
+    startPortalCosts.clear();
+    for (const Portal& portal : startGraph->portals) {
+        startPortalCosts.push_back(cellDistance[(portal.tileY - startChunk.y * side) * side +
+                                                (portal.tileX - startChunk.x * side)]);
+    }
+
+    // 终点接入：终点网格内各入口到终点的代价（以终点为源近似）
+    loadChunkCells(astar, targetChunk);
+    runChunkDijkstra(request.targetX - targetChunk.x * side, request.targetY - targetChunk.y * side);
+    targetPortalCosts.clear();
+    for (const Portal& portal : targetGraph->portals) {
+        targetPortalCosts.push_back(cellDistance[(portal.tileY - targetChunk.y * side) * side +
+                                                 (portal.tileX - targetChunk.x * side)]);
+    }
+
+    // 与AStar相同的智能程度限制
+    float startToEndDistance = heuristic(request.startX, request.startY, request.targetX, request.targetY);
+    float intelligenceLimit = request.intelligence * startToEndDistance + (request.intelligence - 1.0f) * 8.0f;
+
+    // 抽象搜索：0号节点固定为终点
+    searchNodes.clear();
+    searchNodeIndex.clear();
+    openHeap.clear();
+    searchNodes.push_back(SearchNode{request.targetX, request.targetY, targetChunk, -1, INF_COST, INF_COST, -1, false});
+    const int targetNode = 0;
+
+    for (size_t i = 0; i < startGraph->portals.size(); ++i) {
+        if (startPortalCosts[i] < INF_COST) {
+            const Portal& portal = startGraph->portals[i];
+            int node = getOrCreateSearchNode(portal.tileX, portal.tileY, startChunk, static_cast<int>(i));
+            relaxSearchNode(node, startPortalCosts[i], -1, request.targetX, request.targetY);
+        }
+    }
+
+    bool found = false;
+    int iterations = 0;
+    std::greater<std::pair<float, int>> compare;
+    while (!openHeap.empty() && iterations < MAX_ABSTRACT_ITERATIONS) {
+        std::pop_heap(openHeap.begin(), openHeap.end(), compare);
+        auto [fCost, index] = openHeap.back();
+        openHeap.pop_back();
+
+        if (searchNodes[index].closed || fCost > searchNodes[index].fCost) {
+            continue; // 过期的堆项
+        }
+        searchNodes[index].closed = true;
+        iterations++;
+
+        if (index == targetNode) {
+            found = true;
+            break;
+        }
+
+        // 复制节点数据：扩展过程中会向searchNodes追加节点
+        SearchNode current = searchNodes[index];
+
+        // 智能程度限制：离终点太远的入口不再扩展
+        if (heuristic(current.tileX, current.tileY, request.targetX, request.targetY) >= intelligenceLimit) {
+            continue;
+        }
+
+        const ChunkGraph* graph = getChunkGraph(astar, current.chunk);
+        if (!graph) continue;
+        const Portal& portal = graph->portals[current.portal];
+
+        // 位于终点网格的入口直接连到终点
+        if (current.chunk == targetChunk && targetPortalCosts[current.portal] < INF_COST) {
+            relaxSearchNode(targetNode, current.gCost + targetPortalCosts[current.portal], index,
+                            request.targetX, request.targetY);
+        }
+
+        // 同一网格内的其他入口
+        for (const PortalEdge& edge : portal.edges) {
+            const Portal& other = graph->portals[edge.target];
+            int node = getOrCreateSearchNode(other.tileX, other.tileY, current.chunk, edge.target);
+            relaxSearchNode(node, current.gCost + edge.cost, index, request.targetX, request.targetY);
+        }
+
+        // 跨越边界到相邻网格中成对的入口
+        for (int direction = 0; direction < 4; ++direction) {
+            int nx = current.tileX + NEIGHBOR_DIRECTIONS[direction][0];
+            int ny = current.tileY + NEIGHBOR_DIRECTIONS[direction][1];
+            GridCoord neighborChunk = tileToChunk(nx, ny);
+            if (neighborChunk == current.chunk) continue;
+
+            const ChunkGraph* neighborGraph = getChunkGraph(astar, neighborChunk);
+            if (!neighborGraph) continue;
+
+            int neighborPortal = findPortal(*neighborGraph, nx, ny);
+            if (neighborPortal < 0) continue;
+
+            int node = getOrCreateSearchNode(nx, ny, neighborChunk, neighborPortal);
+            relaxSearchNode(node, current.gCost + astar.getMoveCost(current.tileX, current.tileY, nx, ny), index,
+                            request.targetX, request.targetY);
+        }
+    }
+
+    if (!found) {
+        return PathfindingResult::NO_PATH;
+    }
+
+    // 回溯抽象路径（不含起点）
+    abstractPath.clear();
+    for (int index = targetNode; index >= 0; index = searchNodes[index].parent) {
+        abstractPath.push_back(index);
+    }
+    std::reverse(abstractPath.begin(), abstractPath.end());
+
+    // 细化：第一段直接取起点Dijkstra的结果，之后的网格内路径段在所在网格内做Dijkstra
+    // 跨越边界的一步本身就是相邻方块；细化REFINED_SEGMENTS段后其余入口作为粗略路径点
+    outPath.push_back(makePathPoint(astar, request.startX, request.startY));
+    appendChunkSegment(astar, startCellParent, startChunk,
+                       searchNodes[abstractPath[0]].tileX, searchNodes[abstractPath[0]].tileY, outPath);
+
+    int refinedSegments = 1;
+    for (size_t i = 1; i < abstractPath.size(); ++i) {
+        const SearchNode& from = searchNodes[abstractPath[i - 1]];
+        const SearchNode& to = searchNodes[abstractPath[i]];
+
+        if (from.chunk == to.chunk && refinedSegments < REFINED_SEGMENTS) {
+            loadChunkCells(astar, to.chunk);
+            runChunkDijkstra(from.tileX - to.chunk.x * side, from.tileY - to.chunk.y * side);
+            appendChunkSegment(astar, cellParent, to.chunk, to.tileX, to.tileY, outPath);
+            refinedSegments++;
+        } else {
+            outPath.push_back(makePathPoint(astar, to.tileX, to.tileY));
+        }
+    }
+
+    return PathfindingResult::SUCCESS;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#ifndef HIERARCHICAL_PATHFINDER_H
+#define HIERARCHICAL_PATHFINDER_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "Pathfinding.h"
+#include "Map.h"
+
+// 分层寻路（HPA*）
+// - 抽象层：在每个已加载网格（MAP_GRID_SIZE×MAP_GRID_SIZE方块）的边界上放置入口，
+//   网格内入口两两之间的代价在网格内预先求出，入口图按网格缓存，网格或相邻网格的方块变化时才重建
+// - 查询：起点/终点接入所在网格的入口，在入口图上做A*，得到跨网格的粗略路径
+// - 细化：只把前几段粗略路径展开为逐格路径（网格内Dijkstra），其余段以入口点作为路径点
+//   （生物会周期性重新寻路，远处的路径段在靠近时才会被细化）
+class HierarchicalPathfinder {
+private:
+    // 网格内入口之间的边
+    struct PortalEdge {
+        int target;                  // 同一网格内的入口下标
+        float cost;                  // 网格内的最短代价
+    };
+
+    // 入口：网格边界上与相邻网格连通的方块
+    struct Portal {
+        int tileX, tileY;            // 全局方块坐标
+        std::vector<PortalEdge> edges;
+    };
+
+    // 单个网格的入口图
+    struct ChunkGraph {
+        const Grid* grid;            // 构建时的网格及其修订号
+        uint32_t revision;
+        const Grid* neighbors[4];    // 构建时的四个相邻网格（边界入口取决于两侧方块）
+        uint32_t neighborRevisions[4];
+        uint32_t checkedQuery;       // 最近一次校验时的查询序号（同一次查询内只校验一次）
+        std::vector<Portal> portals;
+    };
+
+    // 抽象搜索节点
+    struct SearchNode {
+        int tileX, tileY;
+        GridCoord chunk;
+        int portal;                  // 入口下标，终点节点为-1
+        float gCost, fCost;
+        int parent;
+        bool closed;
+    };
+
+    Map* map;
+    std::unordered_map<GridCoord, ChunkGraph> chunkGraphs;
+    uint32_t queryId;
+
+    // 网格内Dijkstra的复用缓冲区（按网格内方块下标）
+    std::vector<uint8_t> cellWalkable;
+    std::vector<float> cellCost;
+    std::vector<float> cellDistance;
+    std::vector<int> cellParent;                 // Dijkstra最短路径树中的父方块，源点为-1
+    std::vector<int> startCellParent;            // 起点Dijkstra的父方块（细化第一段使用）
+    std::vector<int> segmentCells;
+    std::vector<std::pair<float, int>> dijkstraHeap;
+    std::vector<float> startPortalCosts;     // 起点到起点网格各入口的代价
+    std::vector<float> targetPortalCosts;    // 终点网格各入口到终点的代价
+
+    // 抽象搜索的复用缓冲区
+    std::vector<SearchNode> searchNodes;
+    std::unordered_map<int64_t, int> searchNodeIndex;   // 入口方块 -> 搜索节点下标
+    std::vector<std::pair<float, int>> openHeap;        // (fCost, 节点下标) 最小堆
+    std::vector<int> abstractPath;
+
+    static constexpr int REFINED_SEGMENTS = 2;          // 逐格细化的粗略路径段数
+    static constexpr int MAX_PORTAL_RUN = 6;            // 超过该长度的连通边界在两端各放一个入口
+    static constexpr size_t MAX_CACHED_CHUNKS = 256;    // 超过后清理已卸载网格的入口图
+    static constexpr int MAX_ABSTRACT_ITERATIONS = 4096; // 抽象搜索的最大扩展次数
+
+    static int64_t makeKey(int tileX, int tileY) {
+        return (static_cast<int64_t>(tileX) << 32) | static_cast<uint32_t>(tileY);
+    }
+
+    // 获取网格的入口图，网格未加载返回nullptr，过期时重建
+    const ChunkGraph* getChunkGraph(const AStar& astar, const GridCoord& chunk);
+    void buildChunkGraph(const AStar& astar, const GridCoord& chunk, ChunkGraph& graph);
+
+    // 读取网格内所有方块的可通行性和地形耗时到复用缓冲区
+    void loadChunkCells(const AStar& astar, const GridCoord& chunk);
+
+    // 在已读取的网格内，从网格内方块(localX, localY)出发做Dijkstra，结果写入cellDistance/cellParent
+    void runChunkDijkstra(int localX, int localY);
+
+    // 沿Dijkstra的父方块把源点到(endTileX, endTileY)的逐格路径追加到outPath（不含源点）
+    void appendChunkSegment(const AStar& astar, const std::vector<int>& parents, const GridCoord& chunk,
+                            int endTileX, int endTileY, std::vector<PathPoint>& outPath);
+
+    // 清理已卸载网格的入口图
+    void pruneCache();
+
+    int findPortal(const ChunkGraph& graph, int tileX, int tileY) const;
+    int getOrCreateSearchNode(int tileX, int tileY, const GridCoord& chunk, int portal);
+    void relaxSearchNode(int index, float gCost, int parent, int targetX, int targetY);
+
+public:
+    explicit HierarchicalPathfinder(Map* gameMap);
+
+    // 两点相距超过该方块数（切比雪夫距离）时才使用分层寻路
+    static constexpr int MIN_HIERARCHICAL_DISTANCE = GameConstants::MAP_GRID_SIZE;
+
+    // 起点和终点所在网格是否都已加载（否则无法建立入口图）
+    bool canPlan(int startX, int startY, int targetX, int targetY) const;
+
+    // 分层寻路：前REFINED_SEGMENTS段为逐格路径，之后为入口点组成的粗略路径
+    // 智能程度限制与AStar相同：到终点距离超过限制的入口不会被扩展
+    PathfindingResult findPath(const PathfindingRequest& request, const AStar& astar,
+                               std::vector<PathPoint>& outPath);
+
+    size_t getCachedChunkCount() const { return chunkGraphs.size(); }
+};
+
+#endif // HIERARCHICAL_PATHFINDER_H
@@ -0,0 +1,135 @@
+#include "LineOfSight.h"
+#include "Map.h"
+#include "Collider.h"
+#include "Constants.h"
+#include "TileTraversal.h"
+#include <cmath>
+#include <utility>
+
+LineOfSight::LineOfSight(const Map* gameMap)
+    : map(gameMap), hasSmoke(false) {
+}
+
+void LineOfSight::setMap(const Map* gameMap) {
+    map = gameMap;
+    tileLineCache.clear();
+}
+
+void LineOfSight::beginFrame(const std::vector<Collider*>& smokeColliders) {
+    tileLineCache.clear();
+
+    // 清空分桶内容但保留容量，烟雾持续期间每帧不再重新分配；烟雾全部消散后释放分桶
+    if (smokeColliders.empty()) {
+        smokeCells.clear();
+    }
+    for (auto& cell : smokeCells) {
+        cell.second.clear();
+    }
+    hasSmoke = false;
+
+    const float tileSize = static_cast<float>(GameConstants::TILE_SIZE);
+    for (const Collider* collider : smokeColliders) {
+        if (!collider || !collider->getIsActive()) continue;
+
+        float minX, minY, maxX, maxY;
+        if (collider->getType() == ColliderType::CIRCLE) {
+            float radius = collider->getRadius();
+            minX = collider->getCircleX() - radius;
+            maxX = collider->getCircleX() + radius;
+            minY = collider->getCircleY() - radius;
+            maxY = collider->getCircleY() + radius;
+        } else {
+            const SDL_FRect& box = collider->getBoxCollider();
+            minX = box.x;
+            maxX = box.x + box.w;
+            minY = box.y;
+            maxY = box.y + box.h;
+        }
+
+        int minTileX = TileTraversal::toCell(minX, tileSize);
+        int maxTileX = TileTraversal::toCell(maxX, tileSize);
+        int minTileY = TileTraversal::toCell(minY, tileSize);
+        int maxTileY = TileTraversal::toCell(maxY, tileSize);
+        for (int tileX = minTileX; tileX <= maxTileX; ++tileX) {
+            for (int tileY = minTileY; tileY <= maxTileY; ++tileY) {
+                smokeCells[makeKey(tileX, tileY)].push_back(collider);
+            }
+        }
+        hasSmoke = true;
+    }
+}
+
+bool LineOfSight::traceTileLine(int startTileX, int startTileY, int endTileX, int endTileY) const {
+    if (!map) return true;
+
+    // 沿两方块中心连线遍历，遇到不透明方块即被阻挡
+    const float tileSize = static_cast<float>(GameConstants::TILE_SIZE);
+    float x1 = (startTileX + 0.5f) * tileSize;
+    float y1 = (startTileY + 0.5f) * tileSize;
+    float x2 = (endTileX + 0.5f) * tileSize;
+    float y2 = (endTileY + 0.5f) * tileSize;
+
+    bool clear = true;
+    TileTraversal::traverseTiles(x1, y1, x2, y2, [&](int tileX, int tileY, float, float) {
+        if (map->isTileOpaque(tileX, tileY)) {
+            clear = false;
+            return false;
+        }
+        return true;
+    });
+    return clear;
+}
+
+bool LineOfSight::isTileLineClear(int startTileX, int startTileY, int endTileX, int endTileY) {
+    // 规范化方向，使A->B与B->A共享同一缓存项和同一遍历结果
+    if (startTileX > endTileX || (startTileX == endTileX && startTileY > endTileY)) {
+        std::swap(startTileX, endTileX);
+        std::swap(startTileY, endTileY);
+    }
+
+    TilePairKey key{startTileX, startTileY, endTileX, endTileY};
+    auto it = tileLineCache.find(key);
+    if (it != tileLineCache.end()) {
+        return it->second;
+    }
+
+    bool clear = traceTileLine(startTileX, startTileY, endTileX, endTileY);
+    tileLineCache.emplace(key, clear);
+    return clear;
+}
+
+bool LineOfSight::isBlockedBySmoke(float x1, float y1, float x2, float y2) const {
+    bool blocked = false;
+    TileTraversal::traverseTiles(x1, y1, x2, y2, [&](int tileX, int tileY, float, float) {
+        auto cellIt = smokeCells.find(makeKey(tileX, tileY));
+        if (cellIt == smokeCells.end()) {
+            return true;
+        }
+        for (const Collider* collider : cellIt->second) {
+            // 线段与烟雾相交，或起点位于烟雾内部（线段完全在圆内时不会产生交点）
+            float t;
+            if (collider->intersectsSegment(x1, y1, x2, y2, t) ||
+                collider->contains(static_cast<int>(x1), static_cast<int>(y1))) {
+                blocked = true;
+                return false;
+            }
+        }
+        return true;
+    });
+    return blocked;
+}
+
+bool LineOfSight::hasLineOfSight(float startX, float startY, float endX, float endY) {
+    float dx = endX - startX;
+    float dy = endY - startY;
+    if (dx * dx + dy * dy < 1.0f) {
+        return true; // 距离太近，认为可见
+    }
+
+    if (!isTileLineClear(Map::worldToTileIndex(startX), Map::worldToTileIndex(startY),
+                         Map::worldToTileIndex(endX), Map::worldToTileIndex(endY))) {
+        return false;
+    }
+
+    return !hasSmoke || !isBlockedBySmoke(startX, startY, endX, endY);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef LINE_OF_SIGHT_H
+#define LINE_OF_SIGHT_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+class Map;      // 前向声明
+class Collider;
+
+// 视线检测服务
+// - 墙体：沿两端方块中心连线做DDA遍历，逐格读取地图的不透明位图
+//   结果按（起点方块，终点方块）在本帧内缓存，同一对方块只遍历一次
+// - 烟雾：每帧把烟雾视觉碰撞箱按方块分桶，只与线段经过方块中的烟雾做精确线段检测
+// 单次查询的开销与两点间的方块数成正比，与地图上视觉碰撞箱的总数无关
+class LineOfSight {
+private:
+    struct TilePairKey {
+        int startX, startY, endX, endY;
+        bool operator==(const TilePairKey& other) const {
+            return startX == other.startX && startY == other.startY &&
+                   endX == other.endX && endY == other.endY;
+        }
+    };
+
+    struct TilePairKeyHash {
+        size_t operator()(const TilePairKey& key) const {
+            uint64_t h = static_cast<uint32_t>(key.startX);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.startY);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.endX);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.endY);
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    const Map* map;
+    std::unordered_map<TilePairKey, bool, TilePairKeyHash> tileLineCache;       // 本帧方块连线结果
+    std::unordered_map<int64_t, std::vector<const Collider*>> smokeCells;       // 方块 -> 覆盖该方块的烟雾碰撞箱
+    bool hasSmoke;
+
+    static int64_t makeKey(int tileX, int tileY) {
+        return (static_cast<int64_t>(tileX) << 32) | static_cast<uint32_t>(tileY);
+    }
+
+    // 两方块中心连线是否未被不透明方块阻挡（不使用缓存）
+    bool traceTileLine(int startTileX, int startTileY, int endTileX, int endTileY) const;
+
+    // 线段是否被烟雾阻挡
+    bool isBlockedBySmoke(float x1, float y1, float x2, float y2) const;
+
+public:
+    explicit LineOfSight(const Map* gameMap = nullptr);
+
+    void setMap(const Map* gameMap);
+
+    // 每帧开始时调用：清空方块连线缓存，并以本帧的烟雾视觉碰撞箱重建烟雾分桶
+    void beginFrame(const std::vector<Collider*>& smokeColliders);
+
+    // 两方块中心之间是否没有不透明方块（结果在本帧内缓存，与方向无关）
+    bool isTileLineClear(int startTileX, int startTileY, int endTileX, int endTileY);
+
+    // 两点之间是否可见（墙体按方块检测，烟雾按线段精确检测）
+    bool hasLineOfSight(float startX, float startY, float endX, float endY);
+
+    size_t getCachedPairCount() const { return tileLineCache.size(); }
+};
+
+#endif // LINE_OF_SIGHT_H
@@ -4,9 +4,10 @@
 
 #include <SDL3/SDL.h>
 #include <vector>
-#include <queue>
 #include <memory>
 #include <unordered_map>
+#include <array>
+#include <cstdint>
 #include <string>
 #include <filesystem>
 #include "Collider.h"
@@ -27,53 +28,141 @@ namespace std {
     template<>
     struct hash<GridCoord> {
         size_t operator()(const GridCoord& coord) const {
-            return hash<int>()(coord.x) ^ (hash<int>()(coord.y) << 1);
+            // 两个坐标打包为64位后做混合（fmix64），相邻网格的哈希值充分分散
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(coord.x)) << 32) |
+                           static_cast<uint32_t>(coord.y);
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdull;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ull;
+            key ^= key >> 33;
+            return static_cast<size_t>(key);
         }
     };
 }
 
+class Entity;
+class SpatialHash;
+class ChunkStreamer;
+class RegionArchive;
+class ChunkGenerator;
+
 class Map {
 private:
-    std::vector<Collider> obstacles;                                // 障碍物列表
     std::unordered_map<GridCoord, std::unique_ptr<Grid>> grids;    // 网格哈希表
     int loadDistance;                                              // 加载距离（网格数）
     int playerGridX, playerGridY;                                  // 玩家所在的网格坐标
     std::string mapDir;                                            // 地图文件目录
     SDL_Renderer* renderer;                                        // 渲染器引用
-    // 异步加载相关
-    std::queue<GridCoord> gridsToLoadAsync;
-    std::mutex loadQueueMutex;
-    int maxGridsPerFrame; // 每帧最多加载的网格数
+    int maxGridsPerFrame; // 每帧最多接收的网格数（绑定纹理并加入地图）
+    mutable std::vector<const Collider*> sweepColliderBuffer; // 扫掠检测复用缓冲区（仅主线程使用）
+
+    // 网格查找缓存（仅主线程使用）
+    // 以网格坐标对窗口边长取模定位槽位的直接映射窗口，窗口边长大于加载范围，
+    // 玩家周围已加载（及已确认不存在）的网格各占一个槽位，查询不再经过哈希表
+    struct GridCacheSlot {
+        GridCoord coord;
+        Grid* grid;     // 为空表示该坐标没有网格
+        bool valid;
+    };
+    static constexpr int GRID_CACHE_SIDE = 32; // 窗口边长（网格数），须为2的幂
+    mutable std::array<GridCacheSlot, GRID_CACHE_SIDE * GRID_CACHE_SIDE> gridCache;
+    mutable GridCoord lastGridCoord;  // 最近一次查询的网格（连续查询多落在同一网格）
+    mutable Grid* lastGrid;
+    mutable bool lastGridValid;
+
+    static int gridCacheSlotIndex(int gridX, int gridY) {
+        // 2的幂取模，按位与对负坐标同样得到非负余数
+        return (gridY & (GRID_CACHE_SIDE - 1)) * GRID_CACHE_SIDE + (gridX & (GRID_CACHE_SIDE - 1));
+    }
+
+    // 写入/移除网格并同步查找缓存，所有对grids的增删都经过这两个函数
+    void storeGrid(const GridCoord& coord, std::unique_ptr<Grid> grid);
+    void removeGrid(const GridCoord& coord);
+    void updateGridCache(const GridCoord& coord, Grid* grid);
+
+    // 程序化生成器（结果只取决于世界种子和网格坐标，种子保存在地图目录中）
+    std::unique_ptr<ChunkGenerator> generator;
+
+    // 网格烘焙纹理
+    static constexpr float BAKED_ZOOM_THRESHOLD = 0.5f; // 缩放不超过该值时使用烘焙纹理
+    static constexpr uint32_t BAKED_IDLE_FRAMES = 120;  // 烘焙纹理连续多少帧未使用后释放
+    uint32_t renderFrame;                               // 渲染帧序号
+
+    // 区域存档：只保存加载后被修改过的网格（修订号与加入地图时不同），未修改的网格卸载后重新生成
+    static constexpr size_t ARCHIVE_FLUSH_BYTES = 4 * 1024 * 1024; // 暂存的网格数据超过此大小时写入文件
+    std::unique_ptr<RegionArchive> archive;
+    std::unordered_map<GridCoord, uint32_t> savedRevisions;        // 网格加入地图或最近一次保存时的修订号
+
+    // 后台流式加载（加载线程只构建方块数据，纹理绑定和加入地图在主线程完成）
+    static constexpr int UNLOAD_HYSTERESIS = 2; // 超出加载距离这么多圈才卸载，避免在边界来回走动时反复加载
+    std::unique_ptr<ChunkStreamer> streamer;
 
-    // 获取网格文件路径
-    std::string getGridFilePath(int gridX, int gridY) const;
-    
     // 检查网格是否需要加载
     bool isGridInLoadRange(int gridX, int gridY) const;
     
-    // 生成新网格
-    std::unique_ptr<Grid> generateNewGrid(int gridX, int gridY);
+    // 检查已加载的网格是否应保留（加载范围再向外UNLOAD_HYSTERESIS圈）
+    bool isGridInKeepRange(int gridX, int gridY) const;
+    
+    // 按离玩家的圈数提交加载范围内尚未加载的网格（内圈3x3最优先）
+    void requestMissingGrids();
+    
+    // 从文件加载或生成网格（在加载线程调用，只读取构造后不变的成员）
+    std::unique_ptr<Grid> loadOrGenerateGrid(int gridX, int gridY) const;
+    
+    // 生成新网格（线程安全）
+    std::unique_ptr<Grid> generateNewGrid(int gridX, int gridY) const;
+    
+    // 读取地图目录中的世界种子，没有时随机生成并保存
+    uint64_t loadOrCreateWorldSeed() const;
     
-    // 封存网格到文件
+    // 封存网格到区域存档（网格没有修改过时跳过）
     void archiveGrid(int gridX, int gridY, Grid* grid);
     
-    // 从文件加载网格
-    std::unique_ptr<Grid> loadGridFromFile(int gridX, int gridY);
+    // 从区域存档加载网格（线程安全），没有存档时返回空
+    std::unique_ptr<Grid> loadGridFromFile(int gridX, int gridY) const;
     
-    // 更新障碍物列表
-    void updateObstacles();
-
 public:
     Map(SDL_Renderer* renderer, int loadDist = 4);
     ~Map();
 
-    // 更新方法，每帧调用
+    // 更新方法，每帧调用：接收加载线程完成的网格（绑定纹理后加入地图）
     void update();
 
     void render(SDL_Renderer* renderer, float cameraX, float cameraY);
     
-    // 获取障碍物列表
-    const std::vector<Collider>& getObstacles() const { return obstacles; }
+    // 将指定方块中激活的地形碰撞箱追加到out（方块坐标为全局方块坐标）
+    void appendTileTerrainColliders(int tileX, int tileY, std::vector<const Collider*>& out) const;
+    
+    // 地形查询：收集线段经过的方块中的地形碰撞箱（只遍历线段触及的方块）
+    void queryTerrainAlongSegment(float x1, float y1, float x2, float y2, std::vector<const Collider*>& out) const;
+    
+    // 地形查询：收集与矩形区域重叠的方块中的地形碰撞箱
+    void queryTerrainInRect(float minX, float minY, float maxX, float maxY, std::vector<const Collider*>& out) const;
+    
+    // 线段扫掠：按DDA顺序遍历线段经过的方块，在第一个命中地形的方块处停止
+    // 命中地形时返回true，outTerrainT为命中处的线段参数（0-1）
+    // entityHash不为空时，同时收集经过方块内的实体候选（已去重）到entityCandidates
+    bool sweepSegment(float x1, float y1, float x2, float y2, const SpatialHash* entityHash,
+                      std::vector<Entity*>& entityCandidates, float& outTerrainT) const;
+    
+    // 地形射线检测：返回maxDistance内最近的命中距离，未命中返回-1
+    float raycastTerrain(float startX, float startY, float dirX, float dirY, float maxDistance) const;
+    
+    // 将世界坐标转换为全局方块坐标（向下取整，支持负坐标）
+    static int worldToTileIndex(float worldCoord);
+    
+    // 查询全局方块坐标处的方块是否不透明（读取网格的不透明位图，未加载区域视为透明）
+    bool isTileOpaque(int tileX, int tileY) const;
+    
+    // 查询全局方块坐标处的方块是否可通行（读取网格的可通行位图，未加载区域视为可通行）
+    bool isTileWalkable(int tileX, int tileY) const;
+    
+    // 查询全局方块坐标处的移动耗时（读取网格的量化耗时，未加载区域为100）
+    float getTileMoveCost(int tileX, int tileY) const;
+    
+    // 网格(gridX, gridY)第localY行的可通行位（第i位对应该行第i个方块，未加载网格全部为1）
+    uint64_t getWalkableRow(int gridX, int gridY, int localY) const;
 
     // 添加网格到地图
     void addGrid(std::unique_ptr<Grid> grid, int gridX, int gridY);
@@ -84,10 +173,19 @@ public:
     // 获取指定网格坐标的网格
     Grid* getGridAtCoord(int gridX, int gridY) const;
     
+    // 获取所有已加载的网格（只读遍历，如生成寻路地形快照）
+    const std::unordered_map<GridCoord, std::unique_ptr<Grid>>& getGrids() const { return grids; }
+    
     // 获取指定世界坐标的方块
     Tile* getTileAt(float worldX, float worldY) const;
     
-    // 更新玩家位置，触发网格加载/卸载
+    // 获取全局方块坐标处的方块（纯整数运算，适合按方块遍历的热点路径）
+    Tile* getTileAtTile(int tileX, int tileY) const;
+    
+    // 将全局方块坐标拆分为网格坐标和网格内方块坐标（向下取整，支持负坐标）
+    static void splitTileIndex(int tileIndex, int& gridIndex, int& localIndex);
+    
+    // 更新玩家位置：跨越网格时卸载保留范围外的网格，撤销不再需要的加载请求并提交新的请求
     void updatePlayerPosition(float worldX, float worldY);
     
     // 初始化地图（生成初始网格）
@@ -98,9 +196,6 @@ public:
     
     // 将网格坐标转换为世界坐标（网格左下角）
     static void gridCoordToWorld(int gridX, int gridY, int& worldX, int& worldY);
-    
-    // 新增：强制更新障碍物列表（公有接口）
-    void forceUpdateObstacles() { updateObstacles(); }
 };
 
 #endif // MAP_H
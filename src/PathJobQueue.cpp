@@ -0,0 +1,165 @@
+#include "PathJobQueue.h"
+#include "TerrainSnapshot.h"
+#include <algorithm>
+#include <functional>
+
+PathJobQueue::PathJobQueue(size_t workerCount)
+    : nextTicket(1), frame(0), inFlight(0), stopping(false) {
+    if (workerCount == 0) {
+        // 给主线程和地图加载留出核心
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 2 ? hardwareThreads - 2 : 1;
+    }
+    workerCount = std::min(workerCount, MAX_WORKERS);
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&PathJobQueue::workerLoop, this);
+    }
+}
+
+PathJobQueue::~PathJobQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void PathJobQueue::removePendingJob(size_t index) {
+    pendingIndex.erase(pendingJobs[index].key);
+    if (index + 1 != pendingJobs.size()) {
+        pendingJobs[index] = std::move(pendingJobs.back());
+        pendingIndex[pendingJobs[index].key] = index;
+    }
+    pendingJobs.pop_back();
+}
+
+void PathJobQueue::detachCreature(void* creature) {
+    auto creatureIt = creatureJobs.find(creature);
+    if (creatureIt == creatureJobs.end()) return;
+
+    auto jobIt = pendingIndex.find(creatureIt->second);
+    creatureJobs.erase(creatureIt);
+    if (jobIt == pendingIndex.end()) return;
+
+    size_t index = jobIt->second;
+    auto& waiters = pendingJobs[index].waiters;
+    waiters.erase(std::remove_if(waiters.begin(), waiters.end(), [creature](const Waiter& waiter) {
+        return waiter.creature == creature;
+    }), waiters.end());
+    if (waiters.empty()) {
+        removePendingJob(index);
+    }
+}
+
+uint64_t PathJobQueue::submit(void* creature, const PathfindingRequest& request, float distance) {
+    // 同一生物只保留最新的请求
+    detachCreature(creature);
+
+    JobKey key{request.startX, request.startY, request.targetX, request.targetY,
+               request.intelligence, request.searchMode};
+    uint64_t ticket = nextTicket++;
+
+    auto jobIt = pendingIndex.find(key);
+    if (jobIt != pendingIndex.end()) {
+        // 相同请求合并为一个任务，优先级取等待者中最高的
+        Job& job = pendingJobs[jobIt->second];
+        job.waiters.push_back(Waiter{creature, ticket});
+        job.distance = std::min(job.distance, distance);
+    } else {
+        pendingIndex.emplace(key, pendingJobs.size());
+        pendingJobs.push_back(Job{key, {Waiter{creature, ticket}}, distance, frame, nullptr});
+    }
+    creatureJobs[creature] = key;
+    return ticket;
+}
+
+void PathJobQueue::cancel(void* creature) {
+    detachCreature(creature);
+}
+
+void PathJobQueue::dispatch(const std::shared_ptr<const TerrainSnapshot>& snapshot) {
+    frame++;
+
+    size_t capacity = workers.size() * MAX_IN_FLIGHT_PER_WORKER;
+    size_t budget = inFlight < capacity ? std::min(MAX_DISPATCH_PER_FRAME, capacity - inFlight) : 0;
+    budget = std::min(budget, pendingJobs.size());
+    if (budget == 0 || !snapshot) return;
+
+    // 选出优先级最高的budget个任务
+    auto priority = [this](size_t index) {
+        const Job& job = pendingJobs[index];
+        return job.distance - AGING_PER_FRAME * static_cast<float>(frame - job.submitFrame);
+    };
+    dispatchOrder.resize(pendingJobs.size());
+    for (size_t i = 0; i < dispatchOrder.size(); ++i) {
+        dispatchOrder[i] = i;
+    }
+    std::partial_sort(dispatchOrder.begin(), dispatchOrder.begin() + budget, dispatchOrder.end(),
+                      [&priority](size_t a, size_t b) { return priority(a) < priority(b); });
+    dispatchOrder.resize(budget);
+
+    // 按下标从大到小移出，交换删除不会影响尚未处理的下标
+    std::sort(dispatchOrder.begin(), dispatchOrder.end(), std::greater<size_t>());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t index : dispatchOrder) {
+            Job& job = pendingJobs[index];
+            for (const Waiter& waiter : job.waiters) {
+                creatureJobs.erase(waiter.creature);
+            }
+            job.snapshot = snapshot;
+            readyJobs.push_back(std::move(job));
+            removePendingJob(index);
+        }
+    }
+    inFlight += budget;
+    workAvailable.notify_all();
+}
+
+void PathJobQueue::collect(std::vector<CompletedJob>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    inFlight -= completedJobs.size();
+    for (auto& job : completedJobs) {
+        out.push_back(std::move(job));
+    }
+    completedJobs.clear();
+}
+
+void PathJobQueue::workerLoop() {
+    // 每个线程独占搜索上下文，热身后不再分配
+    PathSearchContext context;
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this] { return stopping || !readyJobs.empty(); });
+            if (stopping) return;
+            job = std::move(readyJobs.front());
+            readyJobs.pop_front();
+        }
+
+        AStar astar(job.snapshot.get());
+        PathfindingRequest request(job.key.startX, job.key.startY, job.key.targetX, job.key.targetY,
+                                   job.key.intelligence, job.key.searchMode);
+        CompletedJob completed;
+        completed.waiters = std::move(job.waiters);
+        completed.startX = request.startX;
+        completed.startY = request.startY;
+        completed.targetX = request.targetX;
+        completed.targetY = request.targetY;
+        completed.intelligence = request.intelligence;
+        completed.result = astar.findPath(request, context, completed.path);
+        if (completed.result == PathfindingResult::SUCCESS && !completed.path.empty()) {
+            astar.smoothPath(completed.path, context);
+        }
+        completed.snapshot = std::move(job.snapshot);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completedJobs.push_back(std::move(completed));
+    }
+}
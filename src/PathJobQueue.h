@@ -0,0 +1,133 @@
+#pragma once
+#ifndef PATH_JOB_QUEUE_H
+#define PATH_JOB_QUEUE_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "Pathfinding.h"
+
+class TerrainSnapshot;
+
+// 异步寻路任务队列
+// 主线程提交请求，每帧按优先级（离关注点越近越优先，等待越久越优先）分发不超过预算的任务到寻路线程；
+// 寻路线程只读取分发时的地形快照，完成的结果在下一帧由主线程取回
+// - 去重：同一生物只保留最新的待分发请求；起点、终点、智能程度相同的请求合并为一个任务，结果分发给所有等待者
+// - 取消：生物移除时撤销其待分发请求，已在计算中的任务结果由调用方按票据丢弃（票据单调递增）
+class PathJobQueue {
+public:
+    // 等待任务结果的生物及其提交时得到的票据
+    struct Waiter {
+        void* creature;
+        uint64_t ticket;
+    };
+
+    // 已完成的任务
+    struct CompletedJob {
+        std::vector<Waiter> waiters;
+        int startX, startY;              // 请求的起点、终点方块和智能程度
+        int targetX, targetY;
+        float intelligence;
+        PathfindingResult result;
+        std::vector<PathPoint> path;     // 已平滑的路径（世界坐标）
+        std::shared_ptr<const TerrainSnapshot> snapshot; // 计算时使用的地形快照
+    };
+
+private:
+    struct JobKey {
+        int startX, startY;
+        int targetX, targetY;
+        float intelligence;
+        PathSearchMode searchMode;
+
+        bool operator==(const JobKey& other) const {
+            return startX == other.startX && startY == other.startY &&
+                   targetX == other.targetX && targetY == other.targetY &&
+                   intelligence == other.intelligence && searchMode == other.searchMode;
+        }
+    };
+
+    struct JobKeyHash {
+        size_t operator()(const JobKey& key) const {
+            size_t hash = std::hash<int>()(key.startX);
+            hash = hash * 31 + std::hash<int>()(key.startY);
+            hash = hash * 31 + std::hash<int>()(key.targetX);
+            hash = hash * 31 + std::hash<int>()(key.targetY);
+            hash = hash * 31 + std::hash<float>()(key.intelligence);
+            return hash * 31 + static_cast<size_t>(key.searchMode);
+        }
+    };
+
+    struct Job {
+        JobKey key;
+        std::vector<Waiter> waiters;
+        float distance;                              // 离关注点的距离（像素），越小越优先
+        uint32_t submitFrame;                        // 提交时的帧序号
+        std::shared_ptr<const TerrainSnapshot> snapshot; // 分发时绑定的地形快照
+    };
+
+    // 仅主线程访问
+    std::vector<Job> pendingJobs;                            // 待分发的任务
+    std::unordered_map<JobKey, size_t, JobKeyHash> pendingIndex; // 任务 -> pendingJobs下标
+    std::unordered_map<void*, JobKey> creatureJobs;          // 生物 -> 其待分发任务
+    std::vector<size_t> dispatchOrder;                       // 分发排序的复用缓冲区
+    uint64_t nextTicket;
+    uint32_t frame;
+    size_t inFlight;                                         // 已分发但尚未取回的任务数
+
+    // 主线程与寻路线程共享，由mutex保护
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::deque<Job> readyJobs;
+    std::vector<CompletedJob> completedJobs;
+    bool stopping;
+
+    std::vector<std::thread> workers;
+
+    static constexpr size_t MAX_WORKERS = 4;                 // 寻路线程数上限
+    static constexpr size_t MAX_DISPATCH_PER_FRAME = 24;     // 每帧最多分发的任务数
+    static constexpr size_t MAX_IN_FLIGHT_PER_WORKER = 4;    // 每个线程最多积压的任务数（保证优先级及时生效）
+    static constexpr float AGING_PER_FRAME = 64.0f;          // 每等待一帧相当于靠近关注点的像素数，避免远处请求饿死
+
+    // 从待分发列表中移除任务（与末尾交换后弹出）
+    void removePendingJob(size_t index);
+
+    // 撤销生物在待分发任务中的等待，任务没有等待者时一并移除
+    void detachCreature(void* creature);
+
+    void workerLoop();
+
+public:
+    // workerCount为0时按硬件线程数自动选择
+    explicit PathJobQueue(size_t workerCount = 0);
+    ~PathJobQueue();
+
+    PathJobQueue(const PathJobQueue&) = delete;
+    PathJobQueue& operator=(const PathJobQueue&) = delete;
+
+    // 提交寻路请求，返回本次请求的票据（结果到达时用于判断是否仍是该生物最新的请求）
+    // distance为请求起点到关注点（玩家）的距离
+    uint64_t submit(void* creature, const PathfindingRequest& request, float distance);
+
+    // 撤销生物尚未分发的请求
+    void cancel(void* creature);
+
+    // 每帧调用一次：按优先级把不超过预算的任务绑定到snapshot并交给寻路线程
+    void dispatch(const std::shared_ptr<const TerrainSnapshot>& snapshot);
+
+    // 取回已完成的任务（追加到out）
+    void collect(std::vector<CompletedJob>& out);
+
+    // 最近一次发出的票据（票据单调递增，尚未发出时为0）
+    uint64_t getLastTicket() const { return nextTicket - 1; }
+
+    size_t getPendingCount() const { return pendingJobs.size(); }
+    size_t getInFlightCount() const { return inFlight; }
+};
+
+#endif // PATH_JOB_QUEUE_H
@@ -1,4 +1,7 @@
 #include "Pathfinding.h"
+#include "HierarchicalPathfinder.h"
+#include "TerrainSnapshot.h"
+#include "PathJobQueue.h"
 #include "Map.h"
 #include "Tile.h"
 #include "Game.h"
@@ -7,66 +10,269 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <iterator>
 
-// AStar类实现
+// WalkableCorridor类实现
 
-float AStar::calculateHeuristic(int x1, int y1, int x2, int y2) const {
-    // 使用欧几里得距离作为启发式函数
-    int dx = x2 - x1;
-    int dy = y2 - y1;
-    return std::sqrt(dx * dx + dy * dy);
+WalkableCorridor::WalkableCorridor()
+    : source(nullptr), originGridX(0), originY(0), minX(0), maxX(-1), columns(0), height(0) {
+}
+
+void WalkableCorridor::reset(const AStar& astar, int minTileX, int minTileY, int maxTileX, int maxTileY) {
+    int localX, lastGridX;
+    source = &astar;
+    minX = minTileX;
+    maxX = maxTileX;
+    originY = minTileY;
+    Map::splitTileIndex(minTileX, originGridX, localX);
+    Map::splitTileIndex(maxTileX, lastGridX, localX);
+    columns = lastGridX - originGridX + 1;
+    height = maxTileY - minTileY + 1;
+    
+    size_t count = static_cast<size_t>(columns) * height;
+    rowBits.resize(count);
+    rowLoaded.assign(count, 0);
 }
 
-std::vector<std::pair<int, int>> AStar::getNeighbors(int x, int y) const {
-    std::vector<std::pair<int, int>> neighbors;
+bool WalkableCorridor::isRunWalkable(int y, int x0, int x1) {
+    int row = y - originY;
+    if (row < 0 || row >= height || x0 < minX || x1 > maxX) {
+        return false;
+    }
     
-    // 8方向移动（包括对角线）
-    const int directions[8][2] = {
-        {-1, -1}, {-1, 0}, {-1, 1},  // 左上、左、左下
-        { 0, -1},          { 0, 1},  // 上、下
-        { 1, -1}, { 1, 0}, { 1, 1}   // 右上、右、右下
-    };
+    // 逐个网格比较该行被覆盖部分的位掩码（偏移量相对包围盒最左侧网格，总是非负）
+    const int gridSize = GameConstants::MAP_GRID_SIZE;
+    int offset = x0 - originGridX * gridSize;
+    int lastOffset = x1 - originGridX * gridSize;
+    while (offset <= lastOffset) {
+        int column = offset / gridSize;
+        int localX = offset % gridSize;
+        int count = std::min(gridSize - localX, lastOffset - offset + 1);
+        
+        size_t slot = static_cast<size_t>(row) * columns + column;
+        if (!rowLoaded[slot]) {
+            int gridY, localY;
+            Map::splitTileIndex(y, gridY, localY);
+            rowBits[slot] = source->getWalkableRow(originGridX + column, gridY, localY);
+            rowLoaded[slot] = 1;
+        }
+        uint64_t mask = ((uint64_t(1) << count) - 1) << localX;
+        if ((rowBits[slot] & mask) != mask) {
+            return false;
+        }
+        offset += count;
+    }
+    return true;
+}
+
+bool WalkableCorridor::hasDirectPath(int x1, int y1, int x2, int y2) {
+    // 与AStar::hasDirectPath相同的Bresenham步进，连续的x方向步进合并为一段整体检测
+    int dx = std::abs(x2 - x1);
+    int dy = std::abs(y2 - y1);
+    int x = x1;
+    int y = y1;
+    int remaining = 1 + dx + dy;
+    int xInc = (x2 > x1) ? 1 : -1;
+    int yInc = (y2 > y1) ? 1 : -1;
+    int error = dx - dy;
     
-    for (int i = 0; i < 8; ++i) {
-        int newX = x + directions[i][0];
-        int newY = y + directions[i][1];
+    dx *= 2;
+    dy *= 2;
+    
+    while (true) {
+        // error > 0时沿x步进，每步error减少dy，直到error <= 0
+        int steps = 0;
+        if (error > 0) {
+            steps = dy == 0 ? remaining - 1 : std::min((error + dy - 1) / dy, remaining - 1);
+        }
+        int endX = x + steps * xInc;
+        if (!isRunWalkable(y, std::min(x, endX), std::max(x, endX))) {
+            return false;
+        }
         
-        if (isWalkable(newX, newY)) {
-            neighbors.push_back({newX, newY});
+        remaining -= steps + 1;
+        if (remaining <= 0) {
+            return true;
         }
+        x = endX;
+        error -= steps * dy;
+        
+        y += yInc;
+        error += dx;
+    }
+}
+
+// PathSearchContext类实现
+
+PathSearchContext::PathSearchContext()
+    : generation(0), originX(0), originY(0), side(1), expandedCount(0), iterationLimitReached(false) {
+}
+
+void PathSearchContext::begin(int centerX, int centerY, int radius) {
+    side = 2 * radius + 1;
+    originX = centerX - radius;
+    originY = centerY - radius;
+    
+    // 只增不减，窗口变小时沿用已有容量
+    size_t nodeCount = static_cast<size_t>(side) * side;
+    if (nodes.size() < nodeCount) {
+        nodes.resize(nodeCount, PathNode{0.0f, 0.0f, 0.0f, -1, -1, 0, false});
     }
     
-    return neighbors;
+    // 代数回绕时清零所有标记，避免旧节点被误认为已访问
+    if (++generation == 0) {
+        for (auto& node : nodes) {
+            node.generation = 0;
+        }
+        generation = 1;
+    }
+    
+    openHeap.clear();
+    expandedCount = 0;
+    iterationLimitReached = false;
 }
 
-bool AStar::isWalkable(int x, int y) const {
-    if (!map) return false;
+int PathSearchContext::toIndex(int x, int y) const {
+    int localX = x - originX;
+    int localY = y - originY;
+    if (localX < 0 || localY < 0 || localX >= side || localY >= side) {
+        return -1;
+    }
+    return localY * side + localX;
+}
+
+bool PathSearchContext::heapLess(int a, int b) const {
+    const PathNode& nodeA = nodes[a];
+    const PathNode& nodeB = nodes[b];
+    if (nodeA.fCost != nodeB.fCost) {
+        return nodeA.fCost < nodeB.fCost;
+    }
+    // fCost相同时优先扩展更接近终点的节点
+    return nodeA.hCost < nodeB.hCost;
+}
+
+void PathSearchContext::siftUp(int pos) {
+    int index = openHeap[pos];
+    while (pos > 0) {
+        int parentPos = (pos - 1) / 2;
+        int parentIndex = openHeap[parentPos];
+        if (!heapLess(index, parentIndex)) {
+            break;
+        }
+        openHeap[pos] = parentIndex;
+        nodes[parentIndex].heapIndex = pos;
+        pos = parentPos;
+    }
+    openHeap[pos] = index;
+    nodes[index].heapIndex = pos;
+}
+
+void PathSearchContext::siftDown(int pos) {
+    int count = static_cast<int>(openHeap.size());
+    int index = openHeap[pos];
+    while (true) {
+        int child = 2 * pos + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && heapLess(openHeap[child + 1], openHeap[child])) {
+            child++;
+        }
+        if (!heapLess(openHeap[child], index)) {
+            break;
+        }
+        openHeap[pos] = openHeap[child];
+        nodes[openHeap[pos]].heapIndex = pos;
+        pos = child;
+    }
+    openHeap[pos] = index;
+    nodes[index].heapIndex = pos;
+}
+
+bool PathSearchContext::relax(int index, float gCost, float hCost, int parent) {
+    PathNode& node = nodes[index];
+    
+    if (node.generation != generation) {
+        // 本次搜索首次访问
+        node.gCost = gCost;
+        node.hCost = hCost;
+        node.fCost = gCost + hCost;
+        node.parent = parent;
+        node.generation = generation;
+        node.closed = false;
+        openHeap.push_back(index);
+        siftUp(static_cast<int>(openHeap.size()) - 1);
+        return true;
+    }
     
-    // 将网格坐标转换为世界坐标
-    int worldX = x * GameConstants::TILE_SIZE;
-    int worldY = y * GameConstants::TILE_SIZE;
+    if (node.closed || gCost >= node.gCost) {
+        return false;
+    }
     
-    // 获取该位置的tile
-    Tile* tile = map->getTileAt(worldX, worldY);
-    if (!tile) return true; // 如果没有tile，认为可通行
+    // 找到更短的路径：降低键值
+    node.gCost = gCost;
+    node.fCost = gCost + node.hCost;
+    node.parent = parent;
+    siftUp(node.heapIndex);
+    return true;
+}
+
+int PathSearchContext::popMin() {
+    int top = openHeap.front();
+    int last = openHeap.back();
+    openHeap.pop_back();
+    if (!openHeap.empty()) {
+        openHeap[0] = last;
+        nodes[last].heapIndex = 0;
+        siftDown(0);
+    }
     
-    // 检查是否有地形碰撞箱
-    return !tile->hasColliderWithPurpose(ColliderPurpose::TERRAIN);
+    nodes[top].heapIndex = -1;
+    nodes[top].closed = true;
+    expandedCount++;
+    return top;
 }
 
-float AStar::getMoveCost(int fromX, int fromY, int toX, int toY) const {
-    if (!map) return 1.0f;
+// AStar类实现
+
+float AStar::calculateHeuristic(int x1, int y1, int x2, int y2) const {
+    // 使用欧几里得距离作为启发式函数
+    int dx = x2 - x1;
+    int dy = y2 - y1;
+    return std::sqrt(static_cast<float>(dx * dx + dy * dy));
+}
+
+uint64_t AStar::getWalkableRow(int gridX, int gridY, int localY) const {
+    if (snapshot) return snapshot->getWalkableRow(gridX, gridY, localY);
+    if (!map) return 0;
+    return map->getWalkableRow(gridX, gridY, localY);
+}
+
+bool AStar::isWalkable(int x, int y) const {
+    if (snapshot) return snapshot->isWalkable(x, y);
+    if (!map) return false;
     
-    // 将网格坐标转换为世界坐标
-    int worldX = toX * GameConstants::TILE_SIZE;
-    int worldY = toY * GameConstants::TILE_SIZE;
+    // 读取网格的可通行位图（没有地形碰撞箱的方块可通行，没有tile也可通行）
+    return map->isTileWalkable(x, y);
+}
+
+bool AStar::isWalkableInWindow(const PathSearchContext& context, int x, int y) const {
+    return context.toIndex(x, y) >= 0 && isWalkable(x, y);
+}
+
+float AStar::getTerrainCost(int x, int y) const {
+    if (snapshot) return snapshot->getTerrainCost(x, y);
+    if (!map) return 100.0f;
     
-    // 获取目标tile的移动耗时倍数
-    Tile* tile = map->getTileAt(worldX, worldY);
-    float baseCost = tile ? tile->getMoveCost() : 100.0f; // 默认100
+    // 读取网格的量化耗时数组，默认100
+    return map->getTileMoveCost(x, y);
+}
+
+float AStar::getMoveCost(int fromX, int fromY, int toX, int toY) const {
+    if (!map && !snapshot) return 1.0f;
     
-    // 标准化基础耗时（以100为基准）
-    float normalizedCost = baseCost / 100.0f;
+    // 获取目标tile的移动耗时倍数，标准化基础耗时（以100为基准）
+    float normalizedCost = getTerrainCost(toX, toY) / 100.0f;
     
     // 检查是否为对角线移动
     int dx = abs(toX - fromX);
@@ -81,162 +287,339 @@ float AStar::getMoveCost(int fromX, int fromY, int toX, int toY) const {
     }
 }
 
-std::vector<PathPoint> AStar::reconstructPath(PathNode* endNode) const {
-    std::vector<PathPoint> path;
-    PathNode* current = endNode;
+bool AStar::isUniformCostAt(int x, int y) const {
+    float cost = getTerrainCost(x, y);
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if ((dx != 0 || dy != 0) && isWalkable(x + dx, y + dy) && getTerrainCost(x + dx, y + dy) != cost) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void AStar::reconstructPath(const PathSearchContext& context, int endIndex, std::vector<PathPoint>& outPath) const {
+    outPath.clear();
     
-    while (current != nullptr) {
-        // 将网格坐标转换为世界坐标（网格中心）
-        float worldX = current->x * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET;
-        float worldY = current->y * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET;
+    for (int index = endIndex; index >= 0; index = context.getNode(index).parent) {
+        int tileX = context.indexToX(index);
+        int tileY = context.indexToY(index);
         
-        // 获取移动耗时倍数
-        Tile* tile = map->getTileAt(current->x * GameConstants::TILE_SIZE, current->y * GameConstants::TILE_SIZE);
-        float moveCost = tile ? tile->getMoveCost() / 100.0f : 1.0f;
+        // 跳点之间是直线或对角线，逐格走回父节点（A*模式下父节点就是相邻方块）
+        int parent = context.getNode(index).parent;
+        int endX = parent >= 0 ? context.indexToX(parent) : tileX;
+        int endY = parent >= 0 ? context.indexToY(parent) : tileY;
+        int stepX = (endX > tileX) - (endX < tileX);
+        int stepY = (endY > tileY) - (endY < tileY);
         
-        path.emplace_back(worldX, worldY, moveCost);
-        current = current->parent;
+        do {
+            // 将网格坐标转换为世界坐标（网格中心）
+            float worldX = tileX * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET;
+            float worldY = tileY * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET;
+            
+            // 获取移动耗时倍数
+            float moveCost = getTerrainCost(tileX, tileY) / 100.0f;
+            
+            outPath.emplace_back(worldX, worldY, moveCost);
+            tileX += stepX;
+            tileY += stepY;
+        } while (tileX != endX || tileY != endY);
     }
     
     // 反转路径（从起点到终点）
-    std::reverse(path.begin(), path.end());
-    return path;
+    std::reverse(outPath.begin(), outPath.end());
+}
+
+void AStar::expandNeighbors(PathSearchContext& context, int currentIndex, const PathfindingRequest& request) const {
+    // 8方向移动（包括对角线）
+    static const int directions[8][2] = {
+        {-1, -1}, {-1, 0}, {-1, 1},  // 左上、左、左下
+        { 0, -1},          { 0, 1},  // 上、下
+        { 1, -1}, { 1, 0}, { 1, 1}   // 右上、右、右下
+    };
+    
+    const PathNode& current = context.getNode(currentIndex);
+    int currentX = context.indexToX(currentIndex);
+    int currentY = context.indexToY(currentIndex);
+    
+    for (int i = 0; i < 8; ++i) {
+        int nx = currentX + directions[i][0];
+        int ny = currentY + directions[i][1];
+        
+        // 窗口外或已在关闭列表中，跳过
+        int neighborIndex = context.toIndex(nx, ny);
+        if (neighborIndex < 0 || context.isClosed(neighborIndex)) {
+            continue;
+        }
+        
+        if (!isWalkable(nx, ny)) {
+            continue;
+        }
+        
+        // 计算到邻居的代价，更优时打开或更新邻居节点
+        float tentativeGCost = current.gCost + getMoveCost(currentX, currentY, nx, ny);
+        float hCost = context.isVisited(neighborIndex)
+            ? context.getNode(neighborIndex).hCost
+            : calculateHeuristic(nx, ny, request.targetX, request.targetY);
+        context.relax(neighborIndex, tentativeGCost, hCost, currentIndex);
+    }
+}
+
+int AStar::jump(const PathSearchContext& context, int x, int y, int dx, int dy,
+                int targetX, int targetY, float& outCost) const {
+    outCost = 0.0f;
+    
+    while (true) {
+        int nx = x + dx;
+        int ny = y + dy;
+        if (!isWalkableInWindow(context, nx, ny)) {
+            return -1;
+        }
+        
+        outCost += getMoveCost(x, y, nx, ny);
+        x = nx;
+        y = ny;
+        int index = context.toIndex(x, y);
+        
+        // 到达终点，或进入耗时变化的区域（该处退回逐格扩展）
+        if ((x == targetX && y == targetY) || !isUniformCostAt(x, y)) {
+            return index;
+        }
+        
+        if (dx != 0 && dy != 0) {
+            // 对角线：存在强制邻居，或沿水平/竖直分量能跳到跳点
+            if ((!isWalkableInWindow(context, x - dx, y) && isWalkableInWindow(context, x - dx, y + dy)) ||
+                (!isWalkableInWindow(context, x, y - dy) && isWalkableInWindow(context, x + dx, y - dy))) {
+                return index;
+            }
+            float unusedCost;
+            if (jump(context, x, y, dx, 0, targetX, targetY, unusedCost) >= 0 ||
+                jump(context, x, y, 0, dy, targetX, targetY, unusedCost) >= 0) {
+                return index;
+            }
+        } else if (dx != 0) {
+            // 水平：上下被挡住而斜前方可通行时产生强制邻居
+            if ((!isWalkableInWindow(context, x, y + 1) && isWalkableInWindow(context, x + dx, y + 1)) ||
+                (!isWalkableInWindow(context, x, y - 1) && isWalkableInWindow(context, x + dx, y - 1))) {
+                return index;
+            }
+        } else {
+            // 竖直：左右被挡住而斜前方可通行时产生强制邻居
+            if ((!isWalkableInWindow(context, x + 1, y) && isWalkableInWindow(context, x + 1, y + dy)) ||
+                (!isWalkableInWindow(context, x - 1, y) && isWalkableInWindow(context, x - 1, y + dy))) {
+                return index;
+            }
+        }
+    }
 }
 
-std::pair<PathfindingResult, std::vector<PathPoint>> AStar::findPath(const PathfindingRequest& request) {
+void AStar::expandJumpPoints(PathSearchContext& context, int currentIndex, const PathfindingRequest& request) const {
+    const PathNode& current = context.getNode(currentIndex);
+    int x = context.indexToX(currentIndex);
+    int y = context.indexToY(currentIndex);
+    
+    // 按来向剪枝：只保留自然邻居和强制邻居方向（起点没有来向，8个方向都要跳）
+    int directions[8][2];
+    int directionCount = 0;
+    auto addDirection = [&](int dx, int dy) {
+        directions[directionCount][0] = dx;
+        directions[directionCount][1] = dy;
+        directionCount++;
+    };
+    
+    if (current.parent < 0) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx != 0 || dy != 0) addDirection(dx, dy);
+            }
+        }
+    } else {
+        int parentX = context.indexToX(current.parent);
+        int parentY = context.indexToY(current.parent);
+        int dx = (x > parentX) - (x < parentX);
+        int dy = (y > parentY) - (y < parentY);
+        
+        if (dx != 0 && dy != 0) {
+            addDirection(dx, dy);
+            addDirection(dx, 0);
+            addDirection(0, dy);
+            if (!isWalkableInWindow(context, x - dx, y)) addDirection(-dx, dy);
+            if (!isWalkableInWindow(context, x, y - dy)) addDirection(dx, -dy);
+        } else if (dx != 0) {
+            addDirection(dx, 0);
+            if (!isWalkableInWindow(context, x, y + 1)) addDirection(dx, 1);
+            if (!isWalkableInWindow(context, x, y - 1)) addDirection(dx, -1);
+        } else {
+            addDirection(0, dy);
+            if (!isWalkableInWindow(context, x + 1, y)) addDirection(1, dy);
+            if (!isWalkableInWindow(context, x - 1, y)) addDirection(-1, dy);
+        }
+    }
+    
+    for (int i = 0; i < directionCount; ++i) {
+        float jumpCost;
+        int jumpIndex = jump(context, x, y, directions[i][0], directions[i][1],
+                             request.targetX, request.targetY, jumpCost);
+        if (jumpIndex < 0 || context.isClosed(jumpIndex)) {
+            continue;
+        }
+        
+        float hCost = context.isVisited(jumpIndex)
+            ? context.getNode(jumpIndex).hCost
+            : calculateHeuristic(context.indexToX(jumpIndex), context.indexToY(jumpIndex),
+                                 request.targetX, request.targetY);
+        context.relax(jumpIndex, current.gCost + jumpCost, hCost, currentIndex);
+    }
+}
+
+PathfindingResult AStar::findPath(const PathfindingRequest& request, PathSearchContext& context,
+                                  std::vector<PathPoint>& outPath) const {
+    outPath.clear();
+    
     // 检查起点和终点是否可通行
     if (!isWalkable(request.startX, request.startY)) {
-        return {PathfindingResult::START_BLOCKED, {}};
+        return PathfindingResult::START_BLOCKED;
     }
     if (!isWalkable(request.targetX, request.targetY)) {
-        return {PathfindingResult::TARGET_BLOCKED, {}};
+        return PathfindingResult::TARGET_BLOCKED;
     }
     
     // 如果起点就是终点
     if (request.startX == request.targetX && request.startY == request.targetY) {
-        return {PathfindingResult::SUCCESS, {}};
+        return PathfindingResult::SUCCESS;
     }
     
     // 计算智能程度限制
     float startToEndDistance = calculateHeuristic(request.startX, request.startY, request.targetX, request.targetY);
     float intelligenceLimit = request.intelligence * startToEndDistance + (request.intelligence - 1.0f) * 8.0f;
     
-    // 初始化数据结构
-    std::priority_queue<PathNode*, std::vector<PathNode*>, std::greater<PathNode*>> openList;
-    std::unordered_set<std::pair<int, int>, NodeHash> closedList;
-    std::unordered_map<std::pair<int, int>, std::unique_ptr<PathNode>, NodeHash> allNodes;
+    // 被扩展的节点到终点的距离都小于智能限制，因此以终点为中心、半径略大于限制的窗口即可容纳整个搜索
+    int searchRadius = std::min(static_cast<int>(std::ceil(intelligenceLimit)) + 1, MAX_SEARCH_RADIUS);
+    context.begin(request.targetX, request.targetY, searchRadius);
     
-    // 创建起始节点
-    auto startNode = std::make_unique<PathNode>(request.startX, request.startY);
-    startNode->gCost = 0;
-    startNode->hCost = startToEndDistance;
-    startNode->fCost = startNode->hCost;
+    int startIndex = context.toIndex(request.startX, request.startY);
+    int targetIndex = context.toIndex(request.targetX, request.targetY);
+    if (startIndex < 0) {
+        // 起点超出搜索窗口，距离过远，交给直线移动
+        return PathfindingResult::NO_PATH;
+    }
     
-    PathNode* startPtr = startNode.get();
-    allNodes[{request.startX, request.startY}] = std::move(startNode);
-    openList.push(startPtr);
+    context.relax(startIndex, 0.0f, startToEndDistance, -1);
     
+    bool useJumpPoints = request.searchMode == PathSearchMode::JUMP_POINT;
     int iterations = 0;
     
-    while (!openList.empty() && iterations < 10000) { // 设置最大迭代保护
-        iterations++;
-        
-        // 获取f值最小的节点
-        PathNode* current = openList.top();
-        openList.pop();
-        
-        // 如果已经在关闭列表中，跳过
-        if (closedList.find({current->x, current->y}) != closedList.end()) {
-            continue;
+    while (!context.isOpenEmpty()) {
+        // 最大迭代保护：窗口最大约6.6万个节点，上限低于窗口时可能先于智能限制终止搜索
+        if (iterations >= request.maxIterations) {
+            context.markIterationLimitReached();
+            break;
         }
+        iterations++;
         
-        // 添加到关闭列表
-        closedList.insert({current->x, current->y});
-        
-        // 计算当前节点到终点的距离
-        float currentToEndDistance = calculateHeuristic(current->x, current->y, request.targetX, request.targetY);
+        // 获取f值最小的节点（同时加入关闭列表）
+        int currentIndex = context.popMin();
+        const PathNode& current = context.getNode(currentIndex);
         
         // 检查是否到达目标
-        if (current->x == request.targetX && current->y == request.targetY) {
-            std::vector<PathPoint> path = reconstructPath(current);
-            return {PathfindingResult::SUCCESS, path};
+        if (currentIndex == targetIndex) {
+            reconstructPath(context, currentIndex, outPath);
+            return PathfindingResult::SUCCESS;
         }
         
         // 检查智能程度限制：如果当前节点到终点距离超过智能限制，停止搜索
-        if (currentToEndDistance >= intelligenceLimit) {
+        if (current.hCost >= intelligenceLimit) {
             break; // 智能不足，停止搜索
         }
         
-        // 检查所有邻居
-        std::vector<std::pair<int, int>> neighbors = getNeighbors(current->x, current->y);
-        for (const auto& neighbor : neighbors) {
-            int nx = neighbor.first;
-            int ny = neighbor.second;
-            
-            // 如果邻居在关闭列表中，跳过
-            if (closedList.find({nx, ny}) != closedList.end()) {
-                continue;
-            }
-            
-            // 计算到邻居的代价
-            float tentativeGCost = current->gCost + getMoveCost(current->x, current->y, nx, ny);
-            
-            // 查找或创建邻居节点
-            PathNode* neighborNode = nullptr;
-            auto it = allNodes.find({nx, ny});
-            if (it == allNodes.end()) {
-                auto newNode = std::make_unique<PathNode>(nx, ny);
-                neighborNode = newNode.get();
-                allNodes[{nx, ny}] = std::move(newNode);
-            } else {
-                neighborNode = it->second.get();
-            }
-            
-            // 如果这条路径更好，或者是第一次访问这个节点
-            if (neighborNode->parent == nullptr || tentativeGCost < neighborNode->gCost) {
-                neighborNode->parent = current;
-                neighborNode->gCost = tentativeGCost;
-                neighborNode->hCost = calculateHeuristic(nx, ny, request.targetX, request.targetY);
-                neighborNode->fCost = neighborNode->gCost + neighborNode->hCost;
-                
-                openList.push(neighborNode);
-            }
+        // 耗时一致的区域内跳跃，耗时变化处逐格扩展（等价于加权A*）
+        if (useJumpPoints && isUniformCostAt(context.indexToX(currentIndex), context.indexToY(currentIndex))) {
+            expandJumpPoints(context, currentIndex, request);
+        } else {
+            expandNeighbors(context, currentIndex, request);
         }
     }
     
     // 找不到路径，返回NO_PATH让系统进行直线移动
-    return {PathfindingResult::NO_PATH, {}};
+    return PathfindingResult::NO_PATH;
 }
 
-std::vector<PathPoint> AStar::smoothPath(const std::vector<PathPoint>& path) const {
-    if (path.size() <= 2) return path;
+namespace {
+    // 世界坐标向下取整为方块坐标（截断后对负数修正，避免调用floor）
+    int worldToTile(float worldCoord) {
+        float scaled = worldCoord / GameConstants::TILE_SIZE;
+        int truncated = static_cast<int>(scaled);
+        return truncated - (scaled < static_cast<float>(truncated) ? 1 : 0);
+    }
     
-    std::vector<PathPoint> smoothed;
-    smoothed.push_back(path[0]); // 添加起点
+    int pathTileX(const PathPoint& point) {
+        return worldToTile(point.x);
+    }
     
+    int pathTileY(const PathPoint& point) {
+        return worldToTile(point.y);
+    }
+}
+
+void AStar::smoothPath(std::vector<PathPoint>& path, PathSearchContext& context) const {
+    if (path.size() <= 2) return;
+    
+    // 路径包围盒内的可通行位按网格行缓存，同一行网格只读取一次
+    int minX = pathTileX(path[0]), maxX = minX;
+    int minY = pathTileY(path[0]), maxY = minY;
+    for (const PathPoint& point : path) {
+        int tileX = pathTileX(point);
+        int tileY = pathTileY(point);
+        minX = std::min(minX, tileX);
+        maxX = std::max(maxX, tileX);
+        minY = std::min(minY, tileY);
+        maxY = std::max(maxY, tileY);
+    }
+    WalkableCorridor& corridor = context.getCorridor();
+    corridor.reset(*this, minX, minY, maxX, maxY);
+    
+    // 保留的点依次前移覆盖，写入位置永远不超过读取位置，因此可以原地进行
+    size_t writeIndex = 1; // 起点保留在原位
     size_t current = 0;
+    
     while (current < path.size() - 1) {
-        size_t farthest = current + 1;
-        
-        // 找到最远的可直达点
-        for (size_t i = current + 2; i < path.size(); ++i) {
-            int x1 = static_cast<int>(path[current].x / 64);
-            int y1 = static_cast<int>(path[current].y / 64);
-            int x2 = static_cast<int>(path[i].x / 64);
-            int y2 = static_cast<int>(path[i].y / 64);
-            
-            if (hasDirectPath(x1, y1, x2, y2)) {
-                farthest = i;
-            } else {
+        int x1 = pathTileX(path[current]);
+        int y1 = pathTileY(path[current]);
+        auto isDirect = [&](size_t index) {
+            return corridor.hasDirectPath(x1, y1, pathTileX(path[index]), pathTileY(path[index]));
+        };
+        
+        // 找到可直达的最远点：前几个点逐个探测（狭窄处通常很快遇到阻挡），之后步长倍增，
+        // 遇到阻挡后在最后一段内二分；跳过k个点只需O(log k)次直线检测，不再逐点检测
+        size_t reachable = current + 1;  // 相邻点总是保留为可达
+        size_t blocked = path.size();
+        size_t step = 1;
+        while (reachable + 1 < blocked) {
+            size_t probe = std::min(reachable + step, blocked - 1);
+            if (!isDirect(probe)) {
+                blocked = probe;
                 break;
             }
+            reachable = probe;
+            if (reachable - current >= LINEAR_SMOOTH_PROBES) {
+                step *= 2;
+            }
+        }
+        while (reachable + 1 < blocked) {
+            size_t middle = reachable + (blocked - reachable) / 2;
+            if (isDirect(middle)) {
+                reachable = middle;
+            } else {
+                blocked = middle;
+            }
         }
         
-        current = farthest;
-        smoothed.push_back(path[current]);
+        current = reachable;
+        path[writeIndex++] = path[current];
     }
     
-    return smoothed;
+    path.erase(path.begin() + writeIndex, path.end());
 }
 
 bool AStar::hasDirectPath(int x1, int y1, int x2, int y2) const {
@@ -273,11 +656,156 @@ bool AStar::hasDirectPath(int x1, int y1, int x2, int y2) const {
 
 // CreaturePathfinder类实现
 
+CreaturePathfinder::CreaturePathfinder(Map* gameMap)
+    : map(gameMap),
+      astar(gameMap),
+      hierarchical(std::make_unique<HierarchicalPathfinder>(gameMap)),
+      jobQueue(std::make_unique<PathJobQueue>()),
+      focusX(0.0f), focusY(0.0f) {
+}
+
+CreaturePathfinder::~CreaturePathfinder() = default;
+
+void CreaturePathfinder::beginFrame(float playerX, float playerY) {
+    focusX = playerX;
+    focusY = playerY;
+    
+    // 取回上一帧完成的结果，比生物已采用的结果更旧（或生物已被移除）的直接丢弃
+    std::vector<PathJobQueue::CompletedJob> completed;
+    jobQueue->collect(completed);
+    for (auto& job : completed) {
+        for (const auto& waiter : job.waiters) {
+            auto it = pathDataMap.find(waiter.creature);
+            if (it == pathDataMap.end() || waiter.ticket <= it->second->appliedTicket) {
+                continue;
+            }
+            
+            // 生物已提交更新的请求时仍先使用这份结果（目标通常只移动了少许），最新请求的结果到达后再替换
+            auto& pathData = it->second;
+            pathData->currentPath = job.path;
+            pathData->currentWaypoint = 0;
+            pathData->lastResult = job.result;
+            pathData->appliedTicket = waiter.ticket;
+            if (pathData->pendingTicket == waiter.ticket) {
+                pathData->pendingTicket = 0;
+            }
+            pathData->spliceCount = 0;
+        }
+        
+        // 基于当前快照算出的结果放入缓存，供同一起点和终点的其他生物直接使用
+        if (job.snapshot == terrainSnapshot) {
+            storeCachedPath(PathCacheKey{job.startX, job.startY, job.targetX, job.targetY, job.intelligence},
+                            job.result, job.path);
+        }
+    }
+    
+    // 地图没有变化时沿用同一份快照；快照变化后缓存的路径可能穿过新障碍，全部丢弃
+    if (map) {
+        auto previousSnapshot = terrainSnapshot;
+        terrainSnapshot = TerrainSnapshot::refresh(terrainSnapshot, *map);
+        if (terrainSnapshot != previousSnapshot) {
+            clearPathCache();
+        }
+    }
+    jobQueue->dispatch(terrainSnapshot);
+}
+
+const CreaturePathfinder::PathCacheEntry* CreaturePathfinder::findCachedPath(const PathCacheKey& key) {
+    auto it = pathCacheIndex.find(key);
+    if (it == pathCacheIndex.end()) {
+        return nullptr;
+    }
+    
+    pathCache.splice(pathCache.begin(), pathCache, it->second);
+    return &*it->second;
+}
+
+void CreaturePathfinder::storeCachedPath(const PathCacheKey& key, PathfindingResult result,
+                                         const std::vector<PathPoint>& path) {
+    auto it = pathCacheIndex.find(key);
+    if (it != pathCacheIndex.end()) {
+        it->second->result = result;
+        it->second->path = path;
+        pathCache.splice(pathCache.begin(), pathCache, it->second);
+        return;
+    }
+    
+    // 淘汰最久未使用的项，复用其路径缓冲区
+    if (pathCache.size() >= PATH_CACHE_CAPACITY) {
+        pathCacheIndex.erase(pathCache.back().key);
+        pathCache.splice(pathCache.begin(), pathCache, std::prev(pathCache.end()));
+        PathCacheEntry& entry = pathCache.front();
+        entry.key = key;
+        entry.result = result;
+        entry.path = path;
+    } else {
+        pathCache.push_front(PathCacheEntry{key, result, path});
+    }
+    pathCacheIndex[key] = pathCache.begin();
+}
+
+void CreaturePathfinder::clearPathCache() {
+    pathCache.clear();
+    pathCacheIndex.clear();
+}
+
+void CreaturePathfinder::discardPendingRequest(void* creature, CreaturePathData& pathData) {
+    // 撤销未分发的请求，已分发的请求结果到达时因票据不新于appliedTicket而被丢弃
+    jobQueue->cancel(creature);
+    pathData.pendingTicket = 0;
+    pathData.appliedTicket = jobQueue->getLastTicket();
+}
+
+bool CreaturePathfinder::trySplicePath(CreaturePathData& pathData, int startTileX, int startTileY,
+                                       int targetTileX, int targetTileY) {
+    // 只修补完整寻路得到且仍在跟随的路径；等待中的结果更新时不修补
+    if (pathData.lastResult != PathfindingResult::SUCCESS || pathData.currentPath.empty() ||
+        pathData.pendingTicket != 0 || pathData.spliceCount >= MAX_PATH_SPLICES) {
+        return false;
+    }
+    
+    int oldTargetTileX = worldToTile(static_cast<float>(pathData.lastTargetX));
+    int oldTargetTileY = worldToTile(static_cast<float>(pathData.lastTargetY));
+    if (std::abs(targetTileX - oldTargetTileX) > 1 || std::abs(targetTileY - oldTargetTileY) > 1 ||
+        !astar.isWalkable(targetTileX, targetTileY)) {
+        return false;
+    }
+    
+    // 目标仍在原方块：沿用剩余路径
+    if (targetTileX != oldTargetTileX || targetTileY != oldTargetTileY) {
+        // 目标移动了一格：旧终点与新终点相邻，只修补路径末端
+        std::vector<PathPoint>& path = pathData.currentPath;
+        PathPoint newEnd(targetTileX * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET,
+                         targetTileY * GameConstants::TILE_SIZE + GameConstants::TILE_CENTER_OFFSET,
+                         astar.getTerrainCost(targetTileX, targetTileY) / 100.0f);
+        
+        // 旧终点的前一个点（没有则为生物当前位置）能直线到达新终点时替换旧终点，避免折返
+        int lastIndex = static_cast<int>(path.size()) - 1;
+        int previousTileX = startTileX;
+        int previousTileY = startTileY;
+        if (lastIndex > pathData.currentWaypoint) {
+            previousTileX = pathTileX(path[lastIndex - 1]);
+            previousTileY = pathTileY(path[lastIndex - 1]);
+        }
+        
+        if (astar.hasDirectPath(previousTileX, previousTileY, targetTileX, targetTileY)) {
+            path[lastIndex] = newEnd;
+        } else {
+            path.push_back(newEnd);
+        }
+    }
+    
+    pathData.spliceCount++;
+    return true;
+}
+
 PathfindingResult CreaturePathfinder::requestPath(void* creature, int startX, int startY, int targetX, int targetY, float intelligence) {
     // 获取或创建生物寻路数据
     auto& pathData = pathDataMap[creature];
     if (!pathData) {
         pathData = std::make_unique<CreaturePathData>();
+        // 之前发出的票据属于其他（可能已被移除的同地址）生物
+        pathData->appliedTicket = jobQueue->getLastTicket();
     }
     
     // 检查冷却时间
@@ -285,11 +813,11 @@ PathfindingResult CreaturePathfinder::requestPath(void* creature, int startX, in
         return pathData->lastResult;
     }
     
-    // 将世界坐标转换为网格坐标
-    int gridStartX = startX / GameConstants::TILE_SIZE;
-    int gridStartY = startY / GameConstants::TILE_SIZE;
-    int gridTargetX = targetX / GameConstants::TILE_SIZE;
-    int gridTargetY = targetY / GameConstants::TILE_SIZE;
+    // 将世界坐标转换为网格坐标（向下取整，负坐标落在正确的方块）
+    int gridStartX = worldToTile(static_cast<float>(startX));
+    int gridStartY = worldToTile(static_cast<float>(startY));
+    int gridTargetX = worldToTile(static_cast<float>(targetX));
+    int gridTargetY = worldToTile(static_cast<float>(targetY));
     
     // 检查是否有直接无障碍路径
     if (astar.hasDirectPath(gridStartX, gridStartY, gridTargetX, gridTargetY)) {
@@ -299,39 +827,85 @@ PathfindingResult CreaturePathfinder::requestPath(void* creature, int startX, in
         pathData->lastTargetX = targetX;
         pathData->lastTargetY = targetY;
         
+        // 等待中的异步结果已过时
+        discardPendingRequest(creature, *pathData);
+        
         // 设置短冷却时间（因为不需要复杂计算）- 提高频率
         pathData->cooldown.timer = 0.05f + (rand() % 50) / 1000.0f; // 0.05-0.1秒
         return PathfindingResult::NO_PATH; // 返回NO_PATH让生物直线移动
     }
     
-    // 只有在有障碍物时才使用A*寻路
-    PathfindingRequest request(gridStartX, gridStartY, gridTargetX, gridTargetY, intelligence);
-    
-    // 执行寻路
-    auto result = astar.findPath(request);
-    
-    // 更新寻路数据
-    pathData->lastResult = result.first;
-    pathData->currentPath = result.second;
-    pathData->currentWaypoint = 0;
-    pathData->lastTargetX = targetX;
-    pathData->lastTargetY = targetY;
+    // 目标没动或只移动了一格：修补现有路径的末端，不重新寻路
+    if (trySplicePath(*pathData, gridStartX, gridStartY, gridTargetX, gridTargetY)) {
+        pathData->lastTargetX = targetX;
+        pathData->lastTargetY = targetY;
+        pathData->cooldown.timer = pathData->cooldown.interval;
+        pathData->cooldown.needsUpdate = false;
+        return PathfindingResult::SUCCESS;
+    }
     
-    // 如果成功找到路径，进行路径平滑
-    if (result.first == PathfindingResult::SUCCESS && !result.second.empty()) {
-        pathData->currentPath = astar.smoothPath(pathData->currentPath);
+    // 其他生物刚算过同一起点和终点的路径时直接复用
+    PathCacheKey cacheKey{gridStartX, gridStartY, gridTargetX, gridTargetY, intelligence};
+    if (const PathCacheEntry* cached = findCachedPath(cacheKey)) {
+        discardPendingRequest(creature, *pathData);
+        pathData->currentPath = cached->path;
+        pathData->currentWaypoint = 0;
+        pathData->lastResult = cached->result;
+        pathData->spliceCount = 0;
+        pathData->lastTargetX = targetX;
+        pathData->lastTargetY = targetY;
+        pathData->cooldown.timer = pathData->cooldown.interval;
+        pathData->cooldown.needsUpdate = false;
+        return cached->result;
     }
     
-    // 如果寻路失败，清空路径让生物进行直线移动
-    if (result.first == PathfindingResult::NO_PATH) {
-        pathData->currentPath.clear();
+    // 只有在有障碍物时才使用A*寻路
+    // 地图大部分区域地形耗时一致，使用跳点搜索减少扩展的节点数
+    PathfindingRequest request(gridStartX, gridStartY, gridTargetX, gridTargetY, intelligence,
+                               PathSearchMode::JUMP_POINT);
+    
+    // 跨越网格的远距离寻路使用分层寻路，只细化前几段（入口图缓存依赖地图，在主线程执行）
+    int tileDistance = std::max(std::abs(gridTargetX - gridStartX), std::abs(gridTargetY - gridStartY));
+    if (tileDistance >= HierarchicalPathfinder::MIN_HIERARCHICAL_DISTANCE &&
+        hierarchical->canPlan(gridStartX, gridStartY, gridTargetX, gridTargetY)) {
+        discardPendingRequest(creature, *pathData);
+        
+        // 结果直接写入生物的路径缓冲区，复用其容量
+        PathfindingResult result = hierarchical->findPath(request, astar, pathData->currentPath);
+        
+        // 更新寻路数据
+        pathData->lastResult = result;
+        pathData->currentWaypoint = 0;
+        pathData->lastTargetX = targetX;
+        pathData->lastTargetY = targetY;
+        
+        pathData->spliceCount = 0;
+        
+        // 如果成功找到路径，进行路径平滑
+        if (result == PathfindingResult::SUCCESS && !pathData->currentPath.empty()) {
+            astar.smoothPath(pathData->currentPath, smoothContext);
+        }
+        storeCachedPath(cacheKey, result, pathData->currentPath);
+        
+        // 重置冷却时间
+        pathData->cooldown.timer = pathData->cooldown.interval;
+        pathData->cooldown.needsUpdate = false;
+        
+        return result;
     }
     
-    // 重置冷却时间
+    // 其余请求交给寻路线程，离玩家越近越先计算；结果到达前生物沿用上次的结果
+    float focusDX = static_cast<float>(startX) - focusX;
+    float focusDY = static_cast<float>(startY) - focusY;
+    pathData->pendingTicket = jobQueue->submit(creature, request, std::sqrt(focusDX * focusDX + focusDY * focusDY));
+    pathData->lastTargetX = targetX;
+    pathData->lastTargetY = targetY;
+    
+    // 重置冷却时间（冷却期间不会重复提交）
     pathData->cooldown.timer = pathData->cooldown.interval;
     pathData->cooldown.needsUpdate = false;
     
-    return result.first;
+    return pathData->lastResult;
 }
 
 void CreaturePathfinder::updateCreature(void* creature, float deltaTime) {
@@ -403,6 +977,8 @@ std::pair<float, float> CreaturePathfinder::getDirectMoveDirection(void* creatur
 }
 
 void CreaturePathfinder::removeCreature(void* creature) {
+    // 尚未分发的请求直接撤销；已在计算中的结果到达时找不到生物数据，会被丢弃
+    jobQueue->cancel(creature);
     pathDataMap.erase(creature);
 }
 
@@ -3,32 +3,112 @@
 #define PATHFINDING_H
 
 #include <vector>
-#include <queue>
+#include <list>
 #include <unordered_map>
-#include <unordered_set>
 #include <memory>
-#include <functional>
+#include <cstdint>
+#include <cstdlib>
 
 // 前向声明
 class Map;
 class Tile;
+class HierarchicalPathfinder;
+class TerrainSnapshot;
+class PathJobQueue;
 
-// 路径节点结构
+// 路径节点结构（搜索窗口扁平数组中的元素，下标即窗口内位置）
 struct PathNode {
-    int x, y;                    // 网格坐标
     float gCost;                 // 从起点到当前节点的实际代价
     float hCost;                 // 从当前节点到终点的启发式代价
     float fCost;                 // 总代价 (gCost + hCost)
-    PathNode* parent;            // 父节点指针
+    int parent;                  // 父节点下标，-1表示起点
+    int heapIndex;               // 在开放堆中的位置，-1表示不在堆中
+    uint32_t generation;         // 所属搜索的代数，与上下文当前代数不同即视为未访问
+    bool closed;                 // 是否已在关闭列表中
+};
+
+class AStar;
+
+// 路径平滑使用的可通行位缓存
+// 覆盖路径包围盒，按（网格列, 方块行）缓存一整行网格的可通行位，首次用到时才从地图或快照读取；
+// 直线检测把Bresenham直线拆成水平段，每段按网格行的位掩码整体比较，不再逐格查询地图
+class WalkableCorridor {
+private:
+    const AStar* source;
+    std::vector<uint64_t> rowBits;   // [行][网格列]的可通行位
+    std::vector<uint8_t> rowLoaded;  // 对应的行是否已读取
+    int originGridX;                 // 包围盒最左侧网格列
+    int originY;                     // 包围盒最上方的方块行
+    int minX, maxX;                  // 包围盒的方块列范围
+    int columns, height;
+
+    // 第y行[x0, x1]范围内是否全部可通行（包围盒外视为阻挡）
+    bool isRunWalkable(int y, int x0, int x1);
+
+public:
+    WalkableCorridor();
+
+    // 以[minX, maxX]×[minY, maxY]为范围重置缓存（不读取地图）
+    void reset(const AStar& astar, int minX, int minY, int maxX, int maxY);
+
+    // 与AStar::hasDirectPath经过相同的方块，端点必须位于包围盒内
+    bool hasDirectPath(int x1, int y1, int x2, int y2);
+};
+
+// 寻路搜索上下文
+// 以终点为中心的方形窗口内的节点数组 + 按fCost排序的索引二叉堆（支持降低键值）
+// 每次搜索只递增代数而不清空数组，容量在多次搜索间复用，热身后单次寻路不再分配内存
+class PathSearchContext {
+private:
+    std::vector<PathNode> nodes;     // 窗口内节点（行优先）
+    std::vector<int> openHeap;       // 开放列表：节点下标组成的最小堆
+    uint32_t generation;             // 当前搜索代数
+    int originX, originY;            // 窗口左上角的网格坐标
+    int side;                        // 窗口边长
+    int expandedCount;               // 本次搜索已扩展（弹出）的节点数
+    bool iterationLimitReached;      // 本次搜索是否因迭代上限而终止
+    
+    WalkableCorridor corridor;       // 路径平滑的可通行位缓存（复用容量）
+
+    bool heapLess(int a, int b) const;
+    void siftUp(int pos);
+    void siftDown(int pos);
+
+public:
+    PathSearchContext();
+
+    // 开始一次新搜索：窗口以(centerX, centerY)为中心、半径为radius
+    void begin(int centerX, int centerY, int radius);
+
+    // 网格坐标转节点下标，窗口外返回-1
+    int toIndex(int x, int y) const;
+    int indexToX(int index) const { return originX + index % side; }
+    int indexToY(int index) const { return originY + index / side; }
+
+    PathNode& getNode(int index) { return nodes[index]; }
+    const PathNode& getNode(int index) const { return nodes[index]; }
+
+    // 节点是否已在本次搜索中访问过
+    bool isVisited(int index) const { return nodes[index].generation == generation; }
+    bool isClosed(int index) const { return isVisited(index) && nodes[index].closed; }
+
+    // 以更小的gCost打开节点：未访问则加入开放堆，已在堆中则降低键值
+    // 返回是否更新了节点
+    bool relax(int index, float gCost, float hCost, int parent);
+
+    // 弹出fCost最小的节点下标并标记为关闭
+    int popMin();
+    bool isOpenEmpty() const { return openHeap.empty(); }
     
-    PathNode(int posX, int posY) : x(posX), y(posY), gCost(0), hCost(0), fCost(0), parent(nullptr) {}
+    // 本次搜索扩展的节点数（基准测试和调参使用）
+    int getExpandedCount() const { return expandedCount; }
     
-    // 用于优先队列的比较
-    bool operator>(const PathNode& other) const {
-        return fCost > other.fCost;
-    }
+    // 本次搜索是否因迭代上限而终止（区别于智能限制和无路可走）
+    bool reachedIterationLimit() const { return iterationLimitReached; }
+    void markIterationLimitReached() { iterationLimitReached = true; }
+    
+    WalkableCorridor& getCorridor() { return corridor; }
 };
-
 // 路径点结构（世界坐标）
 struct PathPoint {
     float x, y;                  // 世界坐标
@@ -46,15 +126,26 @@ enum class PathfindingResult {
     TARGET_BLOCKED               // 终点被阻挡
 };
 
+// 寻路搜索方式
+enum class PathSearchMode {
+    ASTAR,                       // 逐格扩展的加权A*
+    JUMP_POINT                   // 跳点搜索：地形耗时一致的区域内沿直线/对角线跳跃，耗时变化处退回逐格扩展
+};
+
 // 寻路请求结构
 struct PathfindingRequest {
     int startX, startY;          // 起点网格坐标
     int targetX, targetY;        // 终点网格坐标
     float intelligence;          // 寻路智能程度 (1.2-8.0)
+    PathSearchMode searchMode;   // 搜索方式
+    int maxIterations;           // 最多扩展的节点数（安全上限，通常先触发智能限制）
     
-    PathfindingRequest(int sX, int sY, int tX, int tY, float intel) 
-        : startX(sX), startY(sY), targetX(tX), targetY(tY), intelligence(intel) {
-        // 现在使用基于距离的智能限制，不再需要maxIterations
+    static constexpr int DEFAULT_MAX_ITERATIONS = 10000;
+    
+    PathfindingRequest(int sX, int sY, int tX, int tY, float intel, PathSearchMode mode = PathSearchMode::ASTAR,
+                       int iterationLimit = DEFAULT_MAX_ITERATIONS)
+        : startX(sX), startY(sY), targetX(tX), targetY(tY), intelligence(intel), searchMode(mode),
+          maxIterations(iterationLimit) {
     }
 };
 
@@ -62,37 +153,61 @@ struct PathfindingRequest {
 class AStar {
 private:
     Map* map;                    // 地图引用
+    const TerrainSnapshot* snapshot; // 地形快照（寻路线程使用），不为空时代替地图查询
     
-    // 节点哈希函数
-    struct NodeHash {
-        size_t operator()(const std::pair<int, int>& pos) const {
-            return std::hash<int>()(pos.first) ^ (std::hash<int>()(pos.second) << 1);
-        }
-    };
+    // 单次搜索窗口的最大半径（网格数），窗口边长为2*半径+1
+    static constexpr int MAX_SEARCH_RADIUS = 128;
+    
+    // 路径平滑时逐点探测的点数，之后按倍增步长探测
+    static constexpr size_t LINEAR_SMOOTH_PROBES = 4;
     
     // 计算启发式距离（欧几里得距离）
     float calculateHeuristic(int x1, int y1, int x2, int y2) const;
     
-    // 获取邻居节点（8方向）
-    std::vector<std::pair<int, int>> getNeighbors(int x, int y) const;
+    // 检查节点是否可通行且位于搜索窗口内（窗口外视为阻挡）
+    bool isWalkableInWindow(const PathSearchContext& context, int x, int y) const;
+    
+    // 方块与周围8个可通行方块的地形耗时是否一致（一致时才能使用跳点剪枝）
+    bool isUniformCostAt(int x, int y) const;
+    
+    // 逐格扩展：把8个方向的相邻方块作为后继
+    void expandNeighbors(PathSearchContext& context, int currentIndex, const PathfindingRequest& request) const;
+    
+    // 跳点扩展：按来向剪枝后沿各方向跳跃，跳点作为后继
+    void expandJumpPoints(PathSearchContext& context, int currentIndex, const PathfindingRequest& request) const;
+    
+    // 从(x, y)沿(dx, dy)跳跃，返回跳点下标（无跳点返回-1），outCost为沿途累计的移动代价
+    int jump(const PathSearchContext& context, int x, int y, int dx, int dy,
+             int targetX, int targetY, float& outCost) const;
+    
+    // 从终点节点沿父节点重建路径，写入outPath（跳点之间的直线段逐格展开）
+    void reconstructPath(const PathSearchContext& context, int endIndex, std::vector<PathPoint>& outPath) const;
+
+public:
+    AStar(Map* gameMap) : map(gameMap), snapshot(nullptr) {}
+    
+    // 在只读地形快照上寻路，不访问地图，可在寻路线程中使用
+    explicit AStar(const TerrainSnapshot* terrainSnapshot) : map(nullptr), snapshot(terrainSnapshot) {}
     
     // 检查节点是否可通行
     bool isWalkable(int x, int y) const;
     
+    // 获取方块的地形耗时（未加载或空方块为100）
+    float getTerrainCost(int x, int y) const;
+    
+    // 网格(gridX, gridY)第localY行的可通行位（未加载网格全部为1）
+    uint64_t getWalkableRow(int gridX, int gridY, int localY) const;
+    
     // 获取移动代价（考虑地形耗时倍数和对角线移动）
     float getMoveCost(int fromX, int fromY, int toX, int toY) const;
     
-    // 重建路径
-    std::vector<PathPoint> reconstructPath(PathNode* endNode) const;
-
-public:
-    AStar(Map* gameMap) : map(gameMap) {}
-    
-    // 执行A*寻路
-    std::pair<PathfindingResult, std::vector<PathPoint>> findPath(const PathfindingRequest& request);
+    // 执行A*寻路，使用context中的节点数组和开放堆，结果写入outPath（复用其容量）
+    PathfindingResult findPath(const PathfindingRequest& request, PathSearchContext& context,
+                               std::vector<PathPoint>& outPath) const;
     
-    // 简化路径（移除不必要的中间点）
-    std::vector<PathPoint> smoothPath(const std::vector<PathPoint>& path) const;
+    // 简化路径（原地移除不必要的中间点）
+    // 每个锚点按倍增步长加二分查找最远的可直达点，直线检测使用context中按网格行缓存的可通行位
+    void smoothPath(std::vector<PathPoint>& path, PathSearchContext& context) const;
     
     // 检查两点间是否有直线路径
     bool hasDirectPath(int x1, int y1, int x2, int y2) const;
@@ -101,7 +216,15 @@ public:
 // 生物寻路管理器
 class CreaturePathfinder {
 private:
+    Map* map;
     AStar astar;
+    std::unique_ptr<HierarchicalPathfinder> hierarchical; // 远距离寻路使用的分层寻路器（主线程执行）
+    PathSearchContext smoothContext;     // 主线程平滑路径使用的缓冲区
+    
+    // 异步寻路：近距离请求提交到寻路线程，在地形快照上计算，下一帧取回结果
+    std::unique_ptr<PathJobQueue> jobQueue;
+    std::shared_ptr<const TerrainSnapshot> terrainSnapshot; // 最近一次发布的地形快照
+    float focusX, focusY;                // 关注点（玩家位置），离关注点越近的请求越先计算
     
     // 寻路冷却管理
     struct PathfindingCooldown {
@@ -122,18 +245,73 @@ private:
         PathfindingCooldown cooldown;           // 寻路冷却
         PathfindingResult lastResult;           // 上次寻路结果
         int lastTargetX, lastTargetY;           // 上次目标位置
+        uint64_t pendingTicket;                 // 等待中的最新异步请求票据，0表示没有
+        uint64_t appliedTicket;                 // 已采用结果的票据，不比它新的结果被丢弃
+        int spliceCount;                        // 上次完整寻路后沿用/拼接路径的次数
         
         CreaturePathData() : currentWaypoint(0), lastResult(PathfindingResult::NO_PATH), 
-                            lastTargetX(-1), lastTargetY(-1) {}
+                            lastTargetX(-1), lastTargetY(-1), pendingTicket(0), appliedTicket(0), spliceCount(0) {}
     };
     
     // 生物寻路数据映射（使用生物指针作为键）
     std::unordered_map<void*, std::unique_ptr<CreaturePathData>> pathDataMap;
+    
+    // 最近寻路结果的LRU缓存（按起点方块、终点方块和智能程度），多个生物可共享
+    // 地形快照变化（地图被修改）时整体清空
+    struct PathCacheKey {
+        int startX, startY;
+        int targetX, targetY;
+        float intelligence;
+        
+        bool operator==(const PathCacheKey& other) const {
+            return startX == other.startX && startY == other.startY &&
+                   targetX == other.targetX && targetY == other.targetY &&
+                   intelligence == other.intelligence;
+        }
+    };
+    
+    struct PathCacheKeyHash {
+        size_t operator()(const PathCacheKey& key) const {
+            size_t hash = std::hash<int>()(key.startX);
+            hash = hash * 31 + std::hash<int>()(key.startY);
+            hash = hash * 31 + std::hash<int>()(key.targetX);
+            hash = hash * 31 + std::hash<int>()(key.targetY);
+            return hash * 31 + std::hash<float>()(key.intelligence);
+        }
+    };
+    
+    struct PathCacheEntry {
+        PathCacheKey key;
+        PathfindingResult result;
+        std::vector<PathPoint> path;            // 已平滑的路径
+    };
+    
+    std::list<PathCacheEntry> pathCache;        // 最近使用的在前
+    std::unordered_map<PathCacheKey, std::list<PathCacheEntry>::iterator, PathCacheKeyHash> pathCacheIndex;
+    
+    static constexpr size_t PATH_CACHE_CAPACITY = 256;   // 缓存的路径数上限
+    static constexpr int MAX_PATH_SPLICES = 8;           // 连续沿用/拼接次数上限，超过后完整重新寻路
+    
+    // 查找缓存的路径，命中时移到最前
+    const PathCacheEntry* findCachedPath(const PathCacheKey& key);
+    void storeCachedPath(const PathCacheKey& key, PathfindingResult result, const std::vector<PathPoint>& path);
+    void clearPathCache();
+    
+    // 放弃生物等待中的异步请求（改用直线移动、缓存或分层寻路的结果时）
+    void discardPendingRequest(void* creature, CreaturePathData& pathData);
+    
+    // 目标未移动或只移动了一格时修补现有路径的末端，返回是否成功
+    bool trySplicePath(CreaturePathData& pathData, int startTileX, int startTileY, int targetTileX, int targetTileY);
 
 public:
-    CreaturePathfinder(Map* gameMap) : astar(gameMap) {}
+    CreaturePathfinder(Map* gameMap);
+    ~CreaturePathfinder();
+    
+    // 每帧在生物更新前调用一次：取回上一帧完成的异步寻路结果，刷新地形快照并分发新任务
+    void beginFrame(float playerX, float playerY);
     
     // 为生物请求寻路
+    // 近距离寻路异步执行：结果到达前返回上次的结果（生物继续沿旧路径或直线移动）
     PathfindingResult requestPath(void* creature, int startX, int startY, int targetX, int targetY, float intelligence);
     
     // 更新生物寻路状态
@@ -148,7 +326,7 @@ public:
     // 获取直线移动方向
     std::pair<float, float> getDirectMoveDirection(void* creature, int startX, int startY, int targetX, int targetY) const;
     
-    // 清理生物寻路数据
+    // 清理生物寻路数据（同时撤销其尚未完成的异步请求）
     void removeCreature(void* creature);
     
     // 强制重新计算路径
@@ -630,10 +630,10 @@ void Player::attemptShoot() {
     std::cout << "Firing gun in direction (" << dirX << ", " << dirY << ")" << std::endl;
     
     // 射击
-    Bullet* bullet = shootInDirection(gun, dirX, dirY);
+    bool fired = shootInDirection(gun, dirX, dirY);
     
     // 如果射击成功，添加短暂的射击状态
-    if (bullet) {
+    if (fired) {
         std::cout << "Bullet created successfully" << std::endl;
         // 如果不是连续射击状态，添加短暂的射击反馈状态
         if (!hasPlayerState("continuous_shot")) {
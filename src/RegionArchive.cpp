@@ -0,0 +1,429 @@
+#include "RegionArchive.h"
+#include "Grid.h"
+#include "Tile.h"
+#include "Map.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr size_t SLOT_COUNT = RegionArchive::REGION_SIZE * RegionArchive::REGION_SIZE;
+    constexpr size_t TABLE_OFFSET = sizeof(RegionArchive::RegionHeader);
+    constexpr size_t DATA_OFFSET = TABLE_OFFSET + SLOT_COUNT * sizeof(RegionArchive::ChunkSlot);
+    constexpr size_t BLOCK_ALIGNMENT = 4; // 数据块按4字节对齐，结构体可以直接从映射中读取
+
+    enum PaletteFlags : uint8_t {
+        FLAG_COLLISION = 1 << 0,
+        FLAG_TRANSPARENT = 1 << 1,
+        FLAG_DESTRUCTIBLE = 1 << 2
+    };
+
+    template<typename T>
+    void appendValue(std::vector<uint8_t>& out, const T& value) {
+        size_t offset = out.size();
+        out.resize(offset + sizeof(T));
+        std::memcpy(out.data() + offset, &value, sizeof(T));
+    }
+
+    void appendString(std::vector<uint8_t>& out, const std::string& text) {
+        appendValue(out, static_cast<uint16_t>(text.size()));
+        out.insert(out.end(), text.begin(), text.end());
+    }
+
+    // 带边界检查的顺序读取
+    struct ByteReader {
+        const uint8_t* data;
+        size_t size;
+        size_t offset;
+
+        template<typename T>
+        bool read(T& value) {
+            if (size - offset < sizeof(T)) return false;
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string& text) {
+            uint16_t length;
+            if (!read(length) || size - offset < length) return false;
+            text.assign(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            return true;
+        }
+    };
+}
+
+// 只读的文件内存映射
+class RegionArchive::MappedFile {
+private:
+    const uint8_t* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+
+public:
+    MappedFile() : data(nullptr), size(0) {
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = nullptr;
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+#ifdef _WIN32
+        fileHandle = CreateFileW(fs::path(path).wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) return false;
+        mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) return false;
+        data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // 映射建立后不再需要文件描述符
+        if (mapped == MAP_FAILED) return false;
+        data = static_cast<const uint8_t*>(mapped);
+        size = static_cast<size_t>(info.st_size);
+#endif
+        return data != nullptr;
+    }
+
+    const uint8_t* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+RegionArchive::RegionArchive(const std::string& dir)
+    : directory(dir), pendingBytes(0) {
+}
+
+RegionArchive::~RegionArchive() = default;
+
+RegionArchive::RegionCoord RegionArchive::regionOf(int gridX, int gridY, int& slotIndex) {
+    auto floorDiv = [](int value) {
+        return value >= 0 ? value / REGION_SIZE : (value + 1) / REGION_SIZE - 1;
+    };
+    RegionCoord coord{floorDiv(gridX), floorDiv(gridY)};
+    int localX = gridX - coord.x * REGION_SIZE;
+    int localY = gridY - coord.y * REGION_SIZE;
+    slotIndex = localY * REGION_SIZE + localX;
+    return coord;
+}
+
+std::string RegionArchive::getRegionFilePath(const RegionCoord& coord) const {
+    // 文件名：r.regionX.regionY.region
+    std::stringstream ss;
+    ss << directory << "/r." << coord.x << "." << coord.y << ".region";
+    return ss.str();
+}
+
+RegionArchive::Region& RegionArchive::openRegion(const RegionCoord& coord) {
+    Region& region = regions[coord];
+    if (!region.opened) {
+        region.opened = true;
+        std::string path = getRegionFilePath(coord);
+        if (fs::exists(path)) {
+            // 校验文件头，版本或区域不符的文件不使用（之后保存时会被覆盖）
+            auto file = std::make_unique<MappedFile>();
+            if (file->open(path) && file->getSize() >= DATA_OFFSET) {
+                RegionHeader header;
+                std::memcpy(&header, file->getData(), sizeof(header));
+                if (std::memcmp(header.magic, "ZRGN", 4) == 0 && header.version == FORMAT_VERSION &&
+                    header.regionSize == REGION_SIZE && header.regionX == coord.x && header.regionY == coord.y) {
+                    region.file = std::move(file);
+                }
+            }
+            if (!region.file) {
+                std::cerr << "区域存档无法读取或版本不符，已忽略: " << path << std::endl;
+            }
+        }
+    }
+    return region;
+}
+
+bool RegionArchive::findChunk(const MappedFile& file, int slotIndex, const uint8_t*& data, size_t& size) {
+    if (file.getSize() < DATA_OFFSET) return false;
+
+    ChunkSlot slot;
+    std::memcpy(&slot, file.getData() + TABLE_OFFSET + slotIndex * sizeof(ChunkSlot), sizeof(slot));
+    if (slot.offset < DATA_OFFSET || slot.offset > file.getSize() || slot.size > file.getSize() - slot.offset) {
+        return false;
+    }
+    data = file.getData() + slot.offset;
+    size = slot.size;
+    return true;
+}
+
+std::unique_ptr<Grid> RegionArchive::loadChunk(int gridX, int gridY) {
+    int slotIndex;
+    RegionCoord coord = regionOf(gridX, gridY, slotIndex);
+
+    // 解码期间持锁：flush替换文件前会解除映射
+    std::lock_guard<std::mutex> lock(mutex);
+    Region& region = openRegion(coord);
+
+    auto dirtyIt = region.dirtyChunks.find(slotIndex);
+    if (dirtyIt != region.dirtyChunks.end()) {
+        return decodeChunk(dirtyIt->second.data(), dirtyIt->second.size(), gridX, gridY);
+    }
+
+    const uint8_t* data;
+    size_t size;
+    if (!region.file || !findChunk(*region.file, slotIndex, data, size)) {
+        return nullptr;
+    }
+    auto grid = decodeChunk(data, size, gridX, gridY);
+    if (!grid) {
+        std::cerr << "网格存档数据损坏: (" << gridX << ", " << gridY << ")" << std::endl;
+    }
+    return grid;
+}
+
+void RegionArchive::storeChunk(int gridX, int gridY, const Grid& grid) {
+    // 编码不需要持锁
+    std::vector<uint8_t> encoded;
+    encodeChunk(grid, encoded);
+
+    int slotIndex;
+    RegionCoord coord = regionOf(gridX, gridY, slotIndex);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Region& region = openRegion(coord);
+    auto& slot = region.dirtyChunks[slotIndex];
+    pendingBytes -= slot.size();
+    pendingBytes += encoded.size();
+    slot = std::move(encoded);
+}
+
+void RegionArchive::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [coord, region] : regions) {
+        if (region.dirtyChunks.empty()) continue;
+
+        if (writeRegion(coord, region)) {
+            for (const auto& dirty : region.dirtyChunks) {
+                pendingBytes -= dirty.second.size();
+            }
+            region.dirtyChunks.clear();
+        }
+    }
+}
+
+size_t RegionArchive::getPendingBytes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingBytes;
+}
+
+bool RegionArchive::writeRegion(const RegionCoord& coord, Region& region) {
+    // 收集每个槽位最新的数据块：内存中的优先，其次是旧文件中的
+    std::vector<std::pair<const uint8_t*, size_t>> blocks(SLOT_COUNT, {nullptr, 0});
+    for (size_t slotIndex = 0; slotIndex < SLOT_COUNT; ++slotIndex) {
+        auto dirtyIt = region.dirtyChunks.find(static_cast<int>(slotIndex));
+        if (dirtyIt != region.dirtyChunks.end()) {
+            blocks[slotIndex] = {dirtyIt->second.data(), dirtyIt->second.size()};
+        } else if (region.file) {
+            const uint8_t* data;
+            size_t size;
+            if (findChunk(*region.file, static_cast<int>(slotIndex), data, size)) {
+                blocks[slotIndex] = {data, size};
+            }
+        }
+    }
+
+    RegionHeader header{};
+    std::memcpy(header.magic, "ZRGN", 4);
+    header.version = FORMAT_VERSION;
+    header.regionX = coord.x;
+    header.regionY = coord.y;
+    header.regionSize = REGION_SIZE;
+
+    std::vector<ChunkSlot> table(SLOT_COUNT, ChunkSlot{0, 0});
+    size_t offset = DATA_OFFSET;
+    for (size_t slotIndex = 0; slotIndex < SLOT_COUNT; ++slotIndex) {
+        if (!blocks[slotIndex].first) continue;
+        table[slotIndex] = ChunkSlot{static_cast<uint32_t>(offset), static_cast<uint32_t>(blocks[slotIndex].second)};
+        offset += (blocks[slotIndex].second + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+        header.chunkCount++;
+    }
+
+    std::string path = getRegionFilePath(coord);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "错误：无法打开文件进行写入: " << tempPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(ChunkSlot));
+        const char padding[BLOCK_ALIGNMENT] = {};
+        for (const auto& [data, size] : blocks) {
+            if (!data) continue;
+            file.write(reinterpret_cast<const char*>(data), size);
+            file.write(padding, (BLOCK_ALIGNMENT - size % BLOCK_ALIGNMENT) % BLOCK_ALIGNMENT);
+        }
+        if (!file) {
+            std::cerr << "错误：写入区域存档失败: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    // 替换前解除旧文件的映射，下次读取时重新映射新文件
+    region.file.reset();
+    region.opened = false;
+
+    std::error_code error;
+    fs::rename(tempPath, path, error);
+    if (error) {
+        std::cerr << "错误：替换区域存档失败: " << path << " - " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void RegionArchive::encodeChunk(const Grid& grid, std::vector<uint8_t>& out) {
+    const std::vector<Tile>& tiles = grid.getTiles();
+
+    // 类型表：网格中出现的方块类型（通常只有几种）
+    std::vector<const TileType*> palette;
+    auto paletteIndex = [&palette](const Tile& tile) -> uint16_t {
+        if (tile.isEmpty()) return EMPTY_PALETTE;
+        auto it = std::find(palette.begin(), palette.end(), tile.getType());
+        if (it != palette.end()) return static_cast<uint16_t>(it - palette.begin());
+        palette.push_back(tile.getType());
+        return static_cast<uint16_t>(palette.size() - 1);
+    };
+
+    // 相同类型、耗时和旋转的连续方块合并为一个游程
+    std::vector<TileRun> runs;
+    for (const Tile& tile : tiles) {
+        TileRun run{1, paletteIndex(tile), tile.isEmpty() ? 100.0f : tile.getMoveCost(),
+                    static_cast<uint16_t>(tile.isEmpty() ? 0 : static_cast<int>(tile.getRotation())), 0};
+        if (!runs.empty()) {
+            TileRun& last = runs.back();
+            if (last.palette == run.palette && last.moveCost == run.moveCost &&
+                last.rotation == run.rotation && last.length < UINT16_MAX) {
+                last.length++;
+                continue;
+            }
+        }
+        runs.push_back(run);
+    }
+
+    ChunkHeader header{};
+    header.worldX = grid.getX();
+    header.worldY = grid.getY();
+    header.gridSize = static_cast<uint16_t>(grid.getGridSize());
+    header.tileSize = static_cast<uint16_t>(grid.getTileSize());
+    header.paletteCount = static_cast<uint16_t>(palette.size());
+    header.runCount = static_cast<uint32_t>(runs.size());
+
+    out.clear();
+    appendValue(out, header);
+    for (const TileType* type : palette) {
+        uint8_t flags = (type->hasCollision ? FLAG_COLLISION : 0) |
+                        (type->isTransparent ? FLAG_TRANSPARENT : 0) |
+                        (type->isDestructible ? FLAG_DESTRUCTIBLE : 0);
+        appendValue(out, flags);
+        appendString(out, type->name);
+        appendString(out, type->texturePath);
+    }
+    // 游程按4字节对齐，读取时可以直接映射为TileRun数组
+    out.resize((out.size() + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT, 0);
+    size_t runOffset = out.size();
+    out.resize(runOffset + runs.size() * sizeof(TileRun));
+    std::memcpy(out.data() + runOffset, runs.data(), runs.size() * sizeof(TileRun));
+}
+
+std::unique_ptr<Grid> RegionArchive::decodeChunk(const uint8_t* data, size_t size, int gridX, int gridY) {
+    ByteReader reader{data, size, 0};
+
+    // 网格尺寸、方块尺寸和位置必须与请求的网格一致，否则视为损坏（交给生成器重新生成）
+    ChunkHeader header;
+    if (!reader.read(header)) return nullptr;
+    int expectedX, expectedY;
+    Map::gridCoordToWorld(gridX, gridY, expectedX, expectedY);
+    if (header.gridSize != GameConstants::MAP_GRID_SIZE || header.tileSize != GameConstants::TILE_SIZE ||
+        header.worldX != expectedX || header.worldY != expectedY) {
+        return nullptr;
+    }
+
+    // 类型表只在每个网格注册一次，方块直接引用类型指针
+    std::vector<TileType*> palette(header.paletteCount);
+    for (TileType*& type : palette) {
+        uint8_t flags;
+        std::string name, texturePath;
+        if (!reader.read(flags) || !reader.readString(name) || !reader.readString(texturePath)) return nullptr;
+        type = Tile::internType(name, texturePath, (flags & FLAG_COLLISION) != 0,
+                                (flags & FLAG_TRANSPARENT) != 0, (flags & FLAG_DESTRUCTIBLE) != 0);
+    }
+
+    reader.offset = (reader.offset + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+    if (reader.offset > size || (size - reader.offset) / sizeof(TileRun) < header.runCount) return nullptr;
+    const uint8_t* runData = data + reader.offset;
+
+    int gridSize = header.gridSize;
+    int tileCount = gridSize * gridSize;
+    auto grid = std::make_unique<Grid>("ArchivedGrid", header.worldX, header.worldY, gridSize, header.tileSize);
+
+    int index = 0;
+    for (uint32_t i = 0; i < header.runCount; ++i) {
+        TileRun run;
+        std::memcpy(&run, runData + i * sizeof(TileRun), sizeof(run));
+        if (run.length > tileCount - index) return nullptr;
+        if (run.palette != EMPTY_PALETTE && run.palette >= palette.size()) return nullptr;
+
+        for (int end = index + run.length; index < end; ++index) {
+            if (run.palette == EMPTY_PALETTE) continue;
+            Tile tile(palette[run.palette], 0, 0, header.tileSize, run.moveCost);
+            tile.setRotation(static_cast<TileRotation>(run.rotation));
+            grid->addTile(std::move(tile), index % gridSize, index / gridSize);
+        }
+    }
+    return index == tileCount ? std::move(grid) : nullptr;
+}
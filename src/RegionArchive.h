@@ -0,0 +1,129 @@
+#pragma once
+#ifndef REGION_ARCHIVE_H
+#define REGION_ARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+class Grid;
+
+// 区域存档：每个区域文件打包REGION_SIZE x REGION_SIZE个网格
+// 文件布局（小端序）：
+//   RegionHeader（固定32字节）
+//   ChunkSlot[REGION_SIZE * REGION_SIZE]（偏移表，按 localY * REGION_SIZE + localX 排列，offset为0表示没有存档）
+//   各网格数据块：ChunkHeader、方块类型表、游程编码的方块数组
+// 读取时将文件映射到内存，文件头、偏移表和游程直接按结构体读取，不做文本解析
+// 写入的网格先保存在内存中（读取优先使用），flush时把有改动的区域整体重写到临时文件再替换，
+// 顺带回收被覆盖的旧数据块
+// 所有公有方法线程安全（加载线程读取，主线程写入和flush）
+class RegionArchive {
+public:
+    static constexpr int REGION_SIZE = 32;           // 每个区域文件的边长（网格数）
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    // 文件头
+    struct RegionHeader {
+        char magic[4];          // "ZRGN"
+        uint32_t version;
+        int32_t regionX, regionY;
+        uint32_t regionSize;    // 等于REGION_SIZE
+        uint32_t chunkCount;    // 已存档的网格数
+        uint32_t reserved[2];
+    };
+
+    // 偏移表项
+    struct ChunkSlot {
+        uint32_t offset;        // 数据块在文件中的偏移（0表示没有存档）
+        uint32_t size;          // 数据块字节数
+    };
+
+    // 网格数据块头，之后依次为：
+    //   paletteCount个类型：uint8 标志（碰撞/透明/可破坏）、uint16 名称长度、名称、uint16 贴图路径长度、贴图路径
+    //   runCount个TileRun
+    struct ChunkHeader {
+        int32_t worldX, worldY; // 网格位置（世界坐标）
+        uint16_t gridSize;
+        uint16_t tileSize;
+        uint16_t paletteCount;
+        uint16_t reserved;
+        uint32_t runCount;
+    };
+
+    // 连续相同方块的游程（按行优先顺序）
+    struct TileRun {
+        uint16_t length;
+        uint16_t palette;       // 类型表下标，EMPTY_PALETTE表示空格子
+        float moveCost;
+        uint16_t rotation;      // 旋转角度（度）
+        uint16_t reserved;
+    };
+    static constexpr uint16_t EMPTY_PALETTE = 0xFFFF;
+
+private:
+    struct RegionCoord {
+        int x, y;
+        bool operator==(const RegionCoord& other) const { return x == other.x && y == other.y; }
+    };
+    struct RegionCoordHash {
+        size_t operator()(const RegionCoord& coord) const {
+            return std::hash<int64_t>()((static_cast<int64_t>(coord.x) << 32) ^ static_cast<uint32_t>(coord.y));
+        }
+    };
+
+    class MappedFile;
+
+    struct Region {
+        std::unique_ptr<MappedFile> file;                          // 只读映射（文件不存在或损坏时为空）
+        bool opened = false;                                       // 是否已尝试打开
+        std::unordered_map<int, std::vector<uint8_t>> dirtyChunks; // 尚未写入文件的网格数据块（按槽位下标）
+    };
+
+    std::string directory;
+    std::mutex mutex;
+    std::unordered_map<RegionCoord, Region, RegionCoordHash> regions;
+    size_t pendingBytes;                                           // 所有未写入数据块的总字节数
+
+    // 将网格坐标拆分为区域坐标和区域内槽位下标（向下取整，支持负坐标）
+    static RegionCoord regionOf(int gridX, int gridY, int& slotIndex);
+
+    std::string getRegionFilePath(const RegionCoord& coord) const;
+
+    // 获取区域并在首次访问时映射文件（需持锁）
+    Region& openRegion(const RegionCoord& coord);
+
+    // 校验映射的文件并返回槽位对应的数据块（不存在或越界时返回false）
+    static bool findChunk(const MappedFile& file, int slotIndex, const uint8_t*& data, size_t& size);
+
+    // 把区域的全部数据块（文件中未被覆盖的和内存中的）写入新文件并替换旧文件（需持锁）
+    bool writeRegion(const RegionCoord& coord, Region& region);
+
+    static void encodeChunk(const Grid& grid, std::vector<uint8_t>& out);
+    // 解码网格数据块，尺寸或位置与(gridX, gridY)不符时返回空
+    static std::unique_ptr<Grid> decodeChunk(const uint8_t* data, size_t size, int gridX, int gridY);
+
+public:
+    explicit RegionArchive(const std::string& dir);
+    ~RegionArchive();
+
+    RegionArchive(const RegionArchive&) = delete;
+    RegionArchive& operator=(const RegionArchive&) = delete;
+
+    // 读取存档的网格，没有存档或数据损坏时返回空
+    std::unique_ptr<Grid> loadChunk(int gridX, int gridY);
+
+    // 保存网格（编码后暂存在内存中，flush时写入区域文件）
+    void storeChunk(int gridX, int gridY, const Grid& grid);
+
+    // 把所有暂存的网格写入区域文件
+    void flush();
+
+    // 暂存尚未写入文件的字节数
+    size_t getPendingBytes();
+};
+
+#endif // REGION_ARCHIVE_H
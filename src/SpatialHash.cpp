@@ -0,0 +1,139 @@
+#include "SpatialHash.h"
+#include "Entity.h"
+#include <cmath>
+#include <algorithm>
+
+SpatialHash::SpatialHash(float cellSizePx)
+    : cellSize(cellSizePx > 0.0f ? cellSizePx : static_cast<float>(GameConstants::TILE_SIZE)),
+      maxEntityRadius(0) {
+}
+
+SpatialHash::~SpatialHash() {
+    // 解除实体对本哈希的引用，避免实体析构时访问已销毁的哈希
+    for (auto& pair : entityCells) {
+        pair.first->setSpatialHash(nullptr);
+    }
+}
+
+int SpatialHash::toCell(float worldCoord) const {
+    return static_cast<int>(std::floor(worldCoord / cellSize));
+}
+
+void SpatialHash::removeFromCell(int64_t key, Entity* entity) {
+    auto cellIt = cells.find(key);
+    if (cellIt == cells.end()) {
+        return;
+    }
+
+    // 交换删除，格子内顺序无关紧要
+    std::vector<Entity*>& bucket = cellIt->second;
+    auto it = std::find(bucket.begin(), bucket.end(), entity);
+    if (it != bucket.end()) {
+        *it = bucket.back();
+        bucket.pop_back();
+    }
+    // 保留空格子的容量，实体频繁进出同一格子时不再分配内存
+}
+
+void SpatialHash::insert(Entity* entity) {
+    if (!entity) return;
+
+    // 已在其他哈希中登记的实体先移出
+    SpatialHash* owner = entity->getSpatialHash();
+    if (owner && owner != this) {
+        owner->remove(entity);
+    }
+
+    if (entityCells.find(entity) != entityCells.end()) {
+        update(entity);
+        return;
+    }
+
+    int64_t key = makeKey(toCell(entity->getX()), toCell(entity->getY()));
+    cells[key].push_back(entity);
+    entityCells[entity] = key;
+    entity->setSpatialHash(this);
+
+    maxEntityRadius = std::max(maxEntityRadius, entity->getRadius());
+}
+
+void SpatialHash::remove(Entity* entity) {
+    auto it = entityCells.find(entity);
+    if (it == entityCells.end()) {
+        return;
+    }
+
+    removeFromCell(it->second, entity);
+    entityCells.erase(it);
+    entity->setSpatialHash(nullptr);
+}
+
+void SpatialHash::update(Entity* entity) {
+    auto it = entityCells.find(entity);
+    if (it == entityCells.end()) {
+        return;
+    }
+
+    int64_t newKey = makeKey(toCell(entity->getX()), toCell(entity->getY()));
+    if (newKey == it->second) {
+        return; // 仍在原格子中
+    }
+
+    removeFromCell(it->second, entity);
+    cells[newKey].push_back(entity);
+    it->second = newKey;
+}
+
+void SpatialHash::queryRange(float centerX, float centerY, float range, std::vector<Entity*>& out) const {
+    int minCellX = toCell(centerX - range);
+    int maxCellX = toCell(centerX + range);
+    int minCellY = toCell(centerY - range);
+    int maxCellY = toCell(centerY + range);
+
+    for (int cellX = minCellX; cellX <= maxCellX; ++cellX) {
+        for (int cellY = minCellY; cellY <= maxCellY; ++cellY) {
+            auto cellIt = cells.find(makeKey(cellX, cellY));
+            if (cellIt == cells.end()) {
+                continue;
+            }
+            out.insert(out.end(), cellIt->second.begin(), cellIt->second.end());
+        }
+    }
+}
+
+void SpatialHash::queryCellArea(int cellX, int cellY, std::vector<Entity*>& out) const {
+    // 圆心在相邻格子中的实体也可能伸入本格子
+    int margin = static_cast<int>(std::ceil(maxEntityRadius / cellSize));
+
+    for (int x = cellX - margin; x <= cellX + margin; ++x) {
+        for (int y = cellY - margin; y <= cellY + margin; ++y) {
+            auto cellIt = cells.find(makeKey(x, y));
+            if (cellIt == cells.end()) {
+                continue;
+            }
+            out.insert(out.end(), cellIt->second.begin(), cellIt->second.end());
+        }
+    }
+}
+
+void SpatialHash::queryNeighbors(const Entity* entity, std::vector<Entity*>& out) const {
+    if (!entity) return;
+
+    // 两个实体接触的最大中心距离为两者半径之和
+    float range = static_cast<float>(entity->getRadius() + maxEntityRadius);
+
+    size_t start = out.size();
+    queryRange(entity->getX(), entity->getY(), range, out);
+
+    // 移除自身
+    out.erase(std::remove(out.begin() + start, out.end(), entity), out.end());
+}
+
+void SpatialHash::clear() {
+    for (auto& pair : entityCells) {
+        pair.first->setSpatialHash(nullptr);
+    }
+    entityCells.clear();
+    cells.clear();
+    maxEntityRadius = 0;
+}
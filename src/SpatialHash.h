@@ -0,0 +1,66 @@
+#pragma once
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "Constants.h"
+
+class Entity; // 前向声明
+
+// 实体空间哈希（宽相位碰撞检测）
+// 以瓦片大小为格子划分世界，实体只与附近格子中的实体进行碰撞检测
+class SpatialHash {
+private:
+    float cellSize;                                            // 格子大小（像素）
+    std::unordered_map<int64_t, std::vector<Entity*>> cells;   // 格子 -> 实体列表
+    std::unordered_map<Entity*, int64_t> entityCells;          // 实体 -> 所在格子
+    int maxEntityRadius;                                       // 已登记实体中的最大半径
+
+    // 计算世界坐标所在的格子坐标
+    int toCell(float worldCoord) const;
+
+    // 将格子坐标打包为哈希键
+    static int64_t makeKey(int cellX, int cellY) {
+        return (static_cast<int64_t>(cellX) << 32) | static_cast<uint32_t>(cellY);
+    }
+
+    // 从格子中移除实体（不修改entityCells）
+    void removeFromCell(int64_t key, Entity* entity);
+
+public:
+    explicit SpatialHash(float cellSizePx = static_cast<float>(GameConstants::TILE_SIZE));
+    ~SpatialHash();
+
+    SpatialHash(const SpatialHash&) = delete;
+    SpatialHash& operator=(const SpatialHash&) = delete;
+
+    // 登记实体（实体之后通过updatePhysics增量更新所在格子）
+    void insert(Entity* entity);
+
+    // 移除实体
+    void remove(Entity* entity);
+
+    // 实体移动后更新所在格子，格子未变化时只做一次查表
+    void update(Entity* entity);
+
+    // 查询圆形范围内可能接触的实体（结果追加到out，不做精确距离判断）
+    void queryRange(float centerX, float centerY, float range, std::vector<Entity*>& out) const;
+
+    // 查询可能与指定格子接触的实体：该格子及其周围（按最大实体半径外扩）格子中的实体
+    // 格子坐标以本哈希的cellSize为单位（默认与方块大小一致，可直接使用方块坐标）
+    void queryCellArea(int cellX, int cellY, std::vector<Entity*>& out) const;
+
+    // 查询与指定实体可能发生碰撞的邻居（不包含自身）
+    void queryNeighbors(const Entity* entity, std::vector<Entity*>& out) const;
+
+    // 清空所有实体
+    void clear();
+
+    float getCellSize() const { return cellSize; }
+    size_t getEntityCount() const { return entityCells.size(); }
+    int getMaxEntityRadius() const { return maxEntityRadius; }
+};
+
+#endif // SPATIAL_HASH_H
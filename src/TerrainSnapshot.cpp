@@ -0,0 +1,129 @@
+#include "TerrainSnapshot.h"
+#include "Constants.h"
+#include <algorithm>
+
+TerrainSnapshot::TerrainSnapshot()
+    : minGridX(0), minGridY(0), tableWidth(0), tableHeight(0) {
+}
+
+std::shared_ptr<const TerrainSnapshot::ChunkCells> TerrainSnapshot::copyChunk(const Grid& grid) {
+    const int gridSize = GameConstants::MAP_GRID_SIZE;
+    auto cells = std::make_shared<ChunkCells>();
+    cells->grid = &grid;
+    cells->revision = grid.getRevision();
+    cells->walkable.resize(gridSize * gridSize);
+    cells->cost.resize(gridSize * gridSize);
+    cells->walkableRows.resize(gridSize);
+
+    for (int localY = 0; localY < gridSize; ++localY) {
+        cells->walkableRows[localY] = grid.getWalkableRow(localY);
+        for (int localX = 0; localX < gridSize; ++localX) {
+            int index = localY * gridSize + localX;
+            cells->walkable[index] = grid.isTileWalkable(localX, localY) ? 1 : 0;
+            cells->cost[index] = grid.getTileMoveCost(localX, localY);
+        }
+    }
+    return cells;
+}
+
+std::shared_ptr<const TerrainSnapshot> TerrainSnapshot::refresh(const std::shared_ptr<const TerrainSnapshot>& previous,
+                                                                const Map& map) {
+    const auto& grids = map.getGrids();
+
+    // 先确认是否有变化，地图静止时每帧只做一次比较
+    bool changed = !previous || previous->chunks.size() != grids.size();
+    if (!changed) {
+        for (const auto& [coord, grid] : grids) {
+            auto it = previous->chunks.find(coord);
+            if (it == previous->chunks.end() || !grid ||
+                it->second->grid != grid.get() || it->second->revision != grid->getRevision()) {
+                changed = true;
+                break;
+            }
+        }
+    }
+    if (!changed) {
+        return previous;
+    }
+
+    auto snapshot = std::make_shared<TerrainSnapshot>();
+    snapshot->chunks.reserve(grids.size());
+    for (const auto& [coord, grid] : grids) {
+        if (!grid) continue;
+
+        if (previous) {
+            auto it = previous->chunks.find(coord);
+            if (it != previous->chunks.end() &&
+                it->second->grid == grid.get() && it->second->revision == grid->getRevision()) {
+                snapshot->chunks.emplace(coord, it->second);
+                continue;
+            }
+        }
+        snapshot->chunks.emplace(coord, copyChunk(*grid));
+    }
+    snapshot->buildChunkTable();
+    return snapshot;
+}
+
+void TerrainSnapshot::buildChunkTable() {
+    chunkTable.clear();
+    if (chunks.empty()) {
+        tableWidth = tableHeight = 0;
+        return;
+    }
+
+    int maxGridX = chunks.begin()->first.x;
+    int maxGridY = chunks.begin()->first.y;
+    minGridX = maxGridX;
+    minGridY = maxGridY;
+    for (const auto& entry : chunks) {
+        minGridX = std::min(minGridX, entry.first.x);
+        minGridY = std::min(minGridY, entry.first.y);
+        maxGridX = std::max(maxGridX, entry.first.x);
+        maxGridY = std::max(maxGridY, entry.first.y);
+    }
+
+    tableWidth = maxGridX - minGridX + 1;
+    tableHeight = maxGridY - minGridY + 1;
+    chunkTable.assign(static_cast<size_t>(tableWidth) * tableHeight, nullptr);
+    for (const auto& entry : chunks) {
+        chunkTable[(entry.first.y - minGridY) * tableWidth + (entry.first.x - minGridX)] = entry.second.get();
+    }
+}
+
+const TerrainSnapshot::ChunkCells* TerrainSnapshot::findChunk(int tileX, int tileY, int& localIndex) const {
+    int gridX, gridY, localX, localY;
+    Map::splitTileIndex(tileX, gridX, localX);
+    Map::splitTileIndex(tileY, gridY, localY);
+
+    int column = gridX - minGridX;
+    int row = gridY - minGridY;
+    if (column < 0 || row < 0 || column >= tableWidth || row >= tableHeight) {
+        return nullptr;
+    }
+    localIndex = localY * GameConstants::MAP_GRID_SIZE + localX;
+    return chunkTable[row * tableWidth + column];
+}
+
+bool TerrainSnapshot::isWalkable(int tileX, int tileY) const {
+    int localIndex;
+    const ChunkCells* cells = findChunk(tileX, tileY, localIndex);
+    return !cells || cells->walkable[localIndex] != 0;
+}
+
+float TerrainSnapshot::getTerrainCost(int tileX, int tileY) const {
+    int localIndex;
+    const ChunkCells* cells = findChunk(tileX, tileY, localIndex);
+    return cells ? cells->cost[localIndex] : 100.0f;
+}
+
+uint64_t TerrainSnapshot::getWalkableRow(int gridX, int gridY, int localY) const {
+    int column = gridX - minGridX;
+    int row = gridY - minGridY;
+    if (column < 0 || row < 0 || column >= tableWidth || row >= tableHeight ||
+        localY < 0 || localY >= GameConstants::MAP_GRID_SIZE) {
+        return ~uint64_t(0);
+    }
+    const ChunkCells* cells = chunkTable[row * tableWidth + column];
+    return cells ? cells->walkableRows[localY] : ~uint64_t(0);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef TERRAIN_SNAPSHOT_H
+#define TERRAIN_SNAPSHOT_H
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "Map.h"
+
+// 寻路用的只读地形快照
+// 主线程按网格拷贝可通行性和地形耗时，快照发布后不再修改，可被多个寻路线程同时读取；
+// 网格未变化（同一Grid且修订号相同）时新快照直接共享旧快照中该网格的数据
+class TerrainSnapshot {
+private:
+    struct ChunkCells {
+        const Grid* grid;                // 拷贝来源及其修订号
+        uint32_t revision;
+        std::vector<uint8_t> walkable;   // 按行存放，1表示可通行
+        std::vector<uint64_t> walkableRows; // 每行的可通行位（与Grid::getWalkableRow一致）
+        std::vector<float> cost;         // 地形耗时（以100为基准）
+    };
+
+    std::unordered_map<GridCoord, std::shared_ptr<const ChunkCells>> chunks;
+    
+    // 覆盖所有网格的包围矩形内的稠密索引，查询时不经过哈希表（空位表示未加载）
+    std::vector<const ChunkCells*> chunkTable;
+    int minGridX, minGridY;
+    int tableWidth, tableHeight;
+
+    static std::shared_ptr<const ChunkCells> copyChunk(const Grid& grid);
+    void buildChunkTable();
+    const ChunkCells* findChunk(int tileX, int tileY, int& localIndex) const;
+
+public:
+    TerrainSnapshot();
+
+    // 基于上一份快照生成与地图一致的快照；地图没有变化时直接返回previous
+    static std::shared_ptr<const TerrainSnapshot> refresh(const std::shared_ptr<const TerrainSnapshot>& previous,
+                                                          const Map& map);
+
+    // 与AStar直接查询地图的结果一致：未加载区域和空方块可通行，耗时为100
+    bool isWalkable(int tileX, int tileY) const;
+    float getTerrainCost(int tileX, int tileY) const;
+    
+    // 与Map::getWalkableRow一致：未加载网格全部为1
+    uint64_t getWalkableRow(int gridX, int gridY, int localY) const;
+
+    size_t getChunkCount() const { return chunks.size(); }
+};
+
+#endif // TERRAIN_SNAPSHOT_H
@@ -5,33 +5,60 @@
 
 std::unordered_map<std::string, SDL_Texture*> Tile::textureCache;
 std::mutex Tile::textureCacheMutex;
+std::vector<std::unique_ptr<TileType>> Tile::tileTypes;
+std::unordered_map<std::string, TileType*> Tile::tileTypeIndex;
+std::mutex Tile::tileTypeMutex;
+
+TileType* Tile::internType(const std::string& tileName, const std::string& texPath,
+                           bool collision, bool transparent, bool destructible) {
+    // 以名称、贴图路径和属性标志作为类型键
+    std::string key = tileName + '|' + texPath + '|' +
+                      (collision ? '1' : '0') + (transparent ? '1' : '0') + (destructible ? '1' : '0');
+    
+    std::lock_guard<std::mutex> lock(tileTypeMutex);
+    auto it = tileTypeIndex.find(key);
+    if (it != tileTypeIndex.end()) {
+        return it->second;
+    }
+    
+    auto tileType = std::make_unique<TileType>();
+    tileType->name = tileName;
+    tileType->texturePath = texPath;
+    tileType->hasCollision = collision;
+    tileType->isTransparent = transparent;
+    tileType->isDestructible = destructible;
+    tileType->texture = nullptr;
+    tileType->textureFromCache = false;
+    
+    TileType* result = tileType.get();
+    tileTypes.push_back(std::move(tileType));
+    tileTypeIndex[key] = result;
+    return result;
+}
 
 Tile::Tile(const std::string& tileName, const std::string& texPath, bool collision, 
          bool transparent, bool destructible, int posX, int posY, int tileSize, float tileMoveCost) 
-    : name(tileName), texturePath(texPath), texture(nullptr), 
-      hasCollision(collision), isTransparent(transparent), isDestructible(destructible),
-      rotation(TileRotation::ROTATION_0), moveCost(tileMoveCost), x(posX), y(posY), size(tileSize), textureFromCache(false) {
+    : Tile(internType(tileName, texPath, collision, transparent, destructible), posX, posY, tileSize, tileMoveCost) {
+}
+
+Tile::Tile(TileType* tileType, int posX, int posY, int tileSize, float tileMoveCost)
+    : type(tileType),
+      rotation(TileRotation::ROTATION_0), moveCost(tileMoveCost), x(posX), y(posY), size(tileSize) {
     
     // 根据属性自动添加适当的碰撞箱
-    if (hasCollision) {
+    if (type->hasCollision) {
         addTerrainCollider(); // 添加地形碰撞箱（填满整个tile）
     }
     
-    if (!isTransparent) {
+    if (!type->isTransparent) {
         addVisionCollider(); // 如果不透明，添加视线碰撞箱（填满整个tile）
     }
     // 注意：transparent=true意味着不阻挡视线，所以不添加视线碰撞箱
 }
 
-Tile::~Tile() {
-    // 释放纹理资源
-    if (texture && !textureFromCache) {
-        // 只销毁不是从缓存中获取的纹理
-        SDL_DestroyTexture(texture);
-        texture = nullptr;
-    }
-    
-    // colliders会自动清理（使用unique_ptr）
+Tile::Tile()
+    : type(nullptr), rotation(TileRotation::ROTATION_0), moveCost(100.0f),
+      x(0), y(0), size(GameConstants::TILE_SIZE) {
 }
 
 // 新增：碰撞箱管理方法
@@ -77,7 +104,7 @@ void Tile::addTerrainCollider() {
     auto terrainCollider = std::make_unique<Collider>(
         static_cast<float>(x), static_cast<float>(y), 
         static_cast<float>(size), static_cast<float>(size), 
-        "terrain_" + name, ColliderPurpose::TERRAIN, 1
+        "terrain_" + type->name, ColliderPurpose::TERRAIN, 1
     );
     addCollider(std::move(terrainCollider));
 }
@@ -87,7 +114,7 @@ void Tile::addVisionCollider() {
     auto visionCollider = std::make_unique<Collider>(
         static_cast<float>(x), static_cast<float>(y), 
         static_cast<float>(size), static_cast<float>(size), 
-        "vision_" + name, ColliderPurpose::VISION, 2
+        "vision_" + type->name, ColliderPurpose::VISION, 2
     );
     addCollider(std::move(visionCollider));
 }
@@ -104,18 +131,18 @@ void Tile::removeCollidersByPurpose(ColliderPurpose purpose) {
 }
 
 bool Tile::initializeTexture(SDL_Renderer* renderer) {
-    // 如果纹理已经初始化，则不需要再次初始化
-    if (texture) {
+    // 同类型方块共享贴图，已经初始化则不需要再次初始化
+    if (type->texture) {
         return true;
     }
     
     // 检查纹理缓存
     {
         std::lock_guard<std::mutex> lock(textureCacheMutex);
-        auto it = textureCache.find(texturePath);
+        auto it = textureCache.find(type->texturePath);
         if (it != textureCache.end()) {
-            texture = it->second;
-            textureFromCache = true; // 标记为从缓存中获取的纹理
+            type->texture = it->second;
+            type->textureFromCache = true; // 标记为从缓存中获取的纹理
             return true;
         }
     }
@@ -125,9 +152,9 @@ bool Tile::initializeTexture(SDL_Renderer* renderer) {
     bool loadFailed = false;
     
     // 尝试加载原始纹理
-    surface = SDL_LoadBMP(texturePath.c_str());
+    surface = SDL_LoadBMP(type->texturePath.c_str());
     if (!surface) {
-        std::cerr << "无法加载贴图: " << texturePath << " - " << SDL_GetError() << std::endl;
+        std::cerr << "无法加载贴图: " << type->texturePath << " - " << SDL_GetError() << std::endl;
         loadFailed = true;
         
         // 尝试加载备用纹理
@@ -147,7 +174,7 @@ bool Tile::initializeTexture(SDL_Renderer* renderer) {
     }
     
     // 创建贴图
-    texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
     SDL_DestroySurface(surface);
     
     if (!texture) {
@@ -155,11 +182,14 @@ bool Tile::initializeTexture(SDL_Renderer* renderer) {
         return false; // 纹理创建失败
     }
     
+    type->texture = texture;
+    type->textureFromCache = false;
+    
     // 只有成功加载原始纹理时才将其添加到缓存
     if (!loadFailed) {
         std::lock_guard<std::mutex> lock(textureCacheMutex);
-        textureCache[texturePath] = texture;
-        textureFromCache = true; // 标记为已添加到缓存
+        textureCache[type->texturePath] = texture;
+        type->textureFromCache = true; // 标记为已添加到缓存
     }
     
     return true; // 初始化成功
@@ -191,23 +221,27 @@ void Tile::render(SDL_Renderer* renderer, int cameraX, int cameraY) {
         static_cast<float>(size)
     };
     
+    draw(renderer, dstRect);
+}
+
+void Tile::draw(SDL_Renderer* renderer, const SDL_FRect& dstRect) {
     // 如果贴图未初始化，尝试初始化
     bool initSuccess = true;
-    if (!texture) {
+    if (!type->texture) {
         initSuccess = initializeTexture(renderer);
         if (!initSuccess) {
             // 记录初始化失败的信息
             static bool loggedError = false;
             if (!loggedError) {
-                std::cerr << "方块纹理初始化失败: " << name << " 在位置 (" << x << ", " << y << ")" << std::endl;
+                std::cerr << "方块纹理初始化失败: " << type->name << " 在位置 (" << x << ", " << y << ")" << std::endl;
                 loggedError = true; // 只记录一次，避免日志过多
             }
         }
     }
     // 如果贴图已初始化，则渲染贴图
-    if (texture) {
+    if (type->texture) {
         double angle = static_cast<double>(static_cast<int>(rotation));
-        SDL_RenderTextureRotated(renderer, texture, nullptr, &dstRect, angle, nullptr, SDL_FLIP_NONE);
+        SDL_RenderTextureRotated(renderer, type->texture, nullptr, &dstRect, angle, nullptr, SDL_FLIP_NONE);
     } else {
         // 如果仍然没有贴图，渲染一个彩色矩形作为占位符
         if (initSuccess) {
@@ -245,6 +279,18 @@ void Tile::renderColliders(SDL_Renderer* renderer, float cameraX, float cameraY)
 }
 
 void Tile::clearTextureCache() {
+    // 先解除方块类型对贴图的引用，并释放类型独占的备用纹理
+    {
+        std::lock_guard<std::mutex> lock(tileTypeMutex);
+        for (auto& tileType : tileTypes) {
+            if (tileType->texture && !tileType->textureFromCache) {
+                SDL_DestroyTexture(tileType->texture);
+            }
+            tileType->texture = nullptr;
+            tileType->textureFromCache = false;
+        }
+    }
+    
     std::lock_guard<std::mutex> lock(textureCacheMutex);
     // 在清除缓存前记录当前缓存大小
     size_t cacheSize = textureCache.size();
@@ -259,4 +305,4 @@ void Tile::clearTextureCache() {
         
         std::cout << "纹理缓存已清空" << std::endl;
     }
-}
\ No newline at end of file
+}
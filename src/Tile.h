@@ -20,16 +20,29 @@ enum class TileRotation {
     ROTATION_270 = 270 // 270度
 };
 
-class Tile {
-private:
-    static std::unordered_map<std::string, SDL_Texture*> textureCache;
-    static std::mutex textureCacheMutex;
+// 方块类型（享元）：名称、贴图和属性相同的方块共享同一个TileType
+// 每个方块只保存类型指针和自身状态（旋转、移动耗时、位置、碰撞箱）
+struct TileType {
     std::string name;          // 方块名称
     std::string texturePath;   // 贴图路径
-    SDL_Texture* texture;      // 贴图
     bool hasCollision;         // 是否有碰撞箱
     bool isTransparent;        // 是否可视野穿透
     bool isDestructible;       // 是否可破坏
+    SDL_Texture* texture;      // 共享贴图（由Tile::clearTextureCache统一释放）
+    bool textureFromCache;     // 贴图是否来自纹理缓存（否则为该类型独占的备用纹理）
+};
+
+class Tile {
+private:
+    static std::unordered_map<std::string, SDL_Texture*> textureCache;
+    static std::mutex textureCacheMutex;
+    
+    // 方块类型注册表（类型在程序运行期间常驻，指针保持有效）
+    static std::vector<std::unique_ptr<TileType>> tileTypes;
+    static std::unordered_map<std::string, TileType*> tileTypeIndex;
+    static std::mutex tileTypeMutex;
+    
+    TileType* type;            // 方块类型（空方块为nullptr）
     TileRotation rotation;     // 旋转角度
     float moveCost;            // 新增：移动耗时倍数，默认100（平地）
     
@@ -38,30 +51,50 @@ private:
     
     int x, y;                  // 方块位置（世界坐标）
     int size;                  // 方块大小（默认64像素）
-    bool textureFromCache;     // 标记纹理是否来自缓存
 
 public:
     // 构造函数
     Tile(const std::string& tileName, const std::string& texPath, bool collision, 
          bool transparent, bool destructible, int posX, int posY, int tileSize = GameConstants::TILE_SIZE, float tileMoveCost = 100.0f);
-    ~Tile();
+    
+    // 以已注册的方块类型构造（批量创建同类方块时避免重复查找类型）
+    Tile(TileType* tileType, int posX, int posY, int tileSize = GameConstants::TILE_SIZE, float tileMoveCost = 100.0f);
+    
+    // 空方块（网格中未放置方块的格子）
+    Tile();
+    ~Tile() = default;
+    
+    // 方块存放在网格的连续数组中，只允许移动
+    Tile(Tile&&) = default;
+    Tile& operator=(Tile&&) = default;
+    Tile(const Tile&) = delete;
+    Tile& operator=(const Tile&) = delete;
 
     static void clearTextureCache();
     
+    // 获取或注册方块类型（线程安全，类型指针在程序运行期间保持有效）
+    static TileType* internType(const std::string& tileName, const std::string& texPath,
+                                bool collision, bool transparent, bool destructible);
+    
     // 初始化贴图，返回是否成功初始化
     bool initializeTexture(SDL_Renderer* renderer);
 
     // 渲染方块
     void render(SDL_Renderer* renderer, int cameraX, int cameraY);
+    
+    // 把方块绘制到当前渲染目标的dstRect（贴图未初始化时先初始化，失败时绘制占位色块）
+    void draw(SDL_Renderer* renderer, const SDL_FRect& dstRect);
 
     // 设置旋转角度
     void setRotation(TileRotation newRotation);
 
     // 获取方块属性
-    const std::string& getName() const { return name; }
-    bool getHasCollision() const { return hasCollision; }
-    bool getIsTransparent() const { return isTransparent; }
-    bool getIsDestructible() const { return isDestructible; }
+    bool isEmpty() const { return type == nullptr; }
+    const TileType* getType() const { return type; }
+    const std::string& getName() const { return type->name; }
+    bool getHasCollision() const { return type->hasCollision; }
+    bool getIsTransparent() const { return type->isTransparent; }
+    bool getIsDestructible() const { return type->isDestructible; }
     TileRotation getRotation() const { return rotation; }
     
     // 新增：获取和设置移动耗时
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef TILE_TRAVERSAL_H
+#define TILE_TRAVERSAL_H
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include "Constants.h"
+
+// 网格遍历工具（Amanatides–Woo DDA）
+// 按线段前进顺序访问其经过的每个格子，每步只跨越x或y方向上最近的一条格线
+namespace TileTraversal {
+
+    // 世界坐标转格子坐标（向下取整，支持负坐标）
+    inline int toCell(float worldCoord, float cellSize) {
+        return static_cast<int>(std::floor(worldCoord / cellSize));
+    }
+
+    // 遍历线段(x1,y1)->(x2,y2)经过的格子
+    // visitor(cellX, cellY, tEnter, tExit)：tEnter/tExit为线段进入/离开该格子时的参数（0-1）
+    // visitor返回false时停止遍历
+    template<typename Visitor>
+    void traverse(float x1, float y1, float x2, float y2, float cellSize, Visitor&& visitor) {
+        int cellX = toCell(x1, cellSize);
+        int cellY = toCell(y1, cellSize);
+        int endCellX = toCell(x2, cellSize);
+        int endCellY = toCell(y2, cellSize);
+
+        float dx = x2 - x1;
+        float dy = y2 - y1;
+        int stepX = (dx > 0) ? 1 : ((dx < 0) ? -1 : 0);
+        int stepY = (dy > 0) ? 1 : ((dy < 0) ? -1 : 0);
+
+        const float inf = std::numeric_limits<float>::max();
+        // 到达下一条竖直/水平格线时的参数t，以及每跨一格t的增量
+        float tMaxX = (stepX != 0) ? ((cellX + (stepX > 0 ? 1 : 0)) * cellSize - x1) / dx : inf;
+        float tMaxY = (stepY != 0) ? ((cellY + (stepY > 0 ? 1 : 0)) * cellSize - y1) / dy : inf;
+        float tDeltaX = (stepX != 0) ? cellSize / std::abs(dx) : inf;
+        float tDeltaY = (stepY != 0) ? cellSize / std::abs(dy) : inf;
+
+        // 最多经过的格子数，防止浮点误差导致死循环
+        int remaining = std::abs(endCellX - cellX) + std::abs(endCellY - cellY) + 1;
+        float tEnter = 0.0f;
+
+        while (remaining-- > 0) {
+            bool last = (cellX == endCellX && cellY == endCellY) || remaining == 0;
+            float tExit = last ? 1.0f : std::min(1.0f, std::min(tMaxX, tMaxY));
+
+            if (!visitor(cellX, cellY, tEnter, tExit) || last) {
+                return;
+            }
+
+            tEnter = tExit;
+            if (tMaxX < tMaxY) {
+                cellX += stepX;
+                tMaxX += tDeltaX;
+            } else {
+                cellY += stepY;
+                tMaxY += tDeltaY;
+            }
+        }
+    }
+
+    // 以方块大小为格子遍历
+    template<typename Visitor>
+    void traverseTiles(float x1, float y1, float x2, float y2, Visitor&& visitor) {
+        traverse(x1, y1, x2, y2, static_cast<float>(GameConstants::TILE_SIZE), std::forward<Visitor>(visitor));
+    }
+}
+
+#endif // TILE_TRAVERSAL_H
@@ -0,0 +1,126 @@
+#include "VisibilityMap.h"
+#include "Collider.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+VisibilityMap::VisibilityMap(int bins)
+    : binCount(bins > 0 ? bins : 720),
+      binAngle(static_cast<float>(2.0 * M_PI) / (bins > 0 ? bins : 720)),
+      originX(0.0f), originY(0.0f),
+      occluderDistance(binCount, std::numeric_limits<float>::max()),
+      shadowStart(binCount, std::numeric_limits<float>::max()),
+      hasOccluder(false) {
+}
+
+int VisibilityMap::angleToBin(float angle) const {
+    // 归一化到[0, 2π)
+    float twoPi = static_cast<float>(2.0 * M_PI);
+    angle = std::fmod(angle, twoPi);
+    if (angle < 0) angle += twoPi;
+
+    int bin = static_cast<int>(angle / binAngle);
+    return std::min(bin, binCount - 1);
+}
+
+void VisibilityMap::clear() {
+    std::fill(occluderDistance.begin(), occluderDistance.end(), std::numeric_limits<float>::max());
+    std::fill(shadowStart.begin(), shadowStart.end(), std::numeric_limits<float>::max());
+    hasOccluder = false;
+}
+
+void VisibilityMap::rebuild(float x, float y, const std::vector<Collider*>& occluders) {
+    originX = x;
+    originY = y;
+    clear();
+
+    for (const Collider* collider : occluders) {
+        if (collider && collider->getIsActive()) {
+            addOccluder(collider);
+        }
+    }
+}
+
+void VisibilityMap::addOccluder(const Collider* collider) {
+    // 计算遮挡物中心和外接半径
+    float centerX, centerY, extent;
+    if (collider->getType() == ColliderType::CIRCLE) {
+        centerX = collider->getCircleX();
+        centerY = collider->getCircleY();
+        extent = collider->getRadius();
+    } else {
+        const SDL_FRect& box = collider->getBoxCollider();
+        centerX = box.x + box.w / 2;
+        centerY = box.y + box.h / 2;
+        extent = std::sqrt(box.w * box.w + box.h * box.h) / 2;
+    }
+
+    float toCenterX = centerX - originX;
+    float toCenterY = centerY - originY;
+    float centerDistance = std::sqrt(toCenterX * toCenterX + toCenterY * toCenterY);
+    if (centerDistance < MIN_OCCLUDER_DISTANCE) return; // 太近，不产生阴影
+
+    float baseAngle = std::atan2(toCenterY, toCenterX);
+    float minOffset, maxOffset;
+
+    if (collider->getType() == ColliderType::CIRCLE) {
+        // 圆形：切线形成的扇形
+        float radius = collider->getRadius();
+        if (centerDistance <= radius) return;
+        float tangentAngle = std::asin(radius / centerDistance);
+        minOffset = -tangentAngle;
+        maxOffset = tangentAngle;
+    } else {
+        // 矩形：四个角点相对中心方向的角度范围
+        const SDL_FRect& box = collider->getBoxCollider();
+        const float cornersX[4] = { box.x, box.x + box.w, box.x + box.w, box.x };
+        const float cornersY[4] = { box.y, box.y, box.y + box.h, box.y + box.h };
+        minOffset = 0.0f;
+        maxOffset = 0.0f;
+        for (int i = 0; i < 4; ++i) {
+            float offset = std::atan2(cornersY[i] - originY, cornersX[i] - originX) - baseAngle;
+            while (offset > M_PI) offset -= 2 * M_PI;
+            while (offset < -M_PI) offset += 2 * M_PI;
+            minOffset = std::min(minOffset, offset);
+            maxOffset = std::max(maxOffset, offset);
+        }
+    }
+
+    // 覆盖的角度格数量（跨越0度时环绕）
+    int firstBin = angleToBin(baseAngle + minOffset);
+    int lastBin = angleToBin(baseAngle + maxOffset);
+    int count = (lastBin - firstBin + binCount) % binCount + 1;
+    if (maxOffset - minOffset >= 2 * M_PI - binAngle) {
+        count = binCount;
+    }
+
+    // 遮挡物表面距离的保守估计（射线未命中边缘格时使用）
+    float nearDistance = std::max(0.0f, centerDistance - extent);
+
+    for (int i = 0; i < count; ++i) {
+        int bin = (firstBin + i) % binCount;
+        occluderDistance[bin] = std::min(occluderDistance[bin], centerDistance);
+
+        // 沿角度格中心方向求遮挡物表面距离
+        float angle = (bin + 0.5f) * binAngle;
+        float hit = collider->raycast(originX, originY, std::cos(angle), std::sin(angle));
+        float start = (hit >= 0) ? hit : nearDistance;
+        shadowStart[bin] = std::min(shadowStart[bin], start);
+    }
+
+    hasOccluder = true;
+}
+
+bool VisibilityMap::isOccluded(float x, float y) const {
+    if (!hasOccluder) return false;
+
+    float dx = x - originX;
+    float dy = y - originY;
+    int bin = angleToBin(std::atan2(dy, dx));
+    float limit = occluderDistance[bin];
+    return dx * dx + dy * dy >= limit * limit;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef VISIBILITY_MAP_H
+#define VISIBILITY_MAP_H
+
+#include <vector>
+
+class Collider; // 前向声明
+
+// 视野遮挡缓冲（一维角度缓冲）
+// 以观察者为原点把360度划分为若干角度格，每帧从视觉碰撞箱构建一次：
+// - occluderDistance：该方向上最近遮挡物中心的距离，远于它的点处于阴影中
+// - shadowStart：该方向上最近遮挡物表面的距离，战争迷雾从这里开始绘制
+// 构建后点的阴影查询只需一次atan2和一次数组访问
+class VisibilityMap {
+private:
+    int binCount;                         // 角度格数量
+    float binAngle;                       // 每格角度（弧度）
+    float originX, originY;               // 观察者位置
+    std::vector<float> occluderDistance;  // 每格最近遮挡物中心距离（无遮挡为无穷大）
+    std::vector<float> shadowStart;       // 每格阴影起始距离（无遮挡为无穷大）
+    bool hasOccluder;                     // 是否存在任何遮挡
+
+    // 将角度（弧度，任意范围）转换为角度格下标
+    int angleToBin(float angle) const;
+
+    // 将单个遮挡物写入其覆盖的角度格
+    void addOccluder(const Collider* collider);
+
+public:
+    // 遮挡物中心与观察者的最小距离，更近的遮挡物不产生阴影
+    static constexpr float MIN_OCCLUDER_DISTANCE = 32.0f;
+
+    explicit VisibilityMap(int bins = 720);
+
+    // 以(x, y)为观察者重新构建遮挡缓冲
+    void rebuild(float x, float y, const std::vector<Collider*>& occluders);
+
+    // 清空遮挡（所有点均可见）
+    void clear();
+
+    // 检查点是否位于阴影中
+    bool isOccluded(float x, float y) const;
+
+    // 获取器（供战争迷雾渲染使用）
+    int getBinCount() const { return binCount; }
+    float getBinAngle() const { return binAngle; }
+    float getBinStartAngle(int bin) const { return bin * binAngle; }
+    float getOccluderDistance(int bin) const { return occluderDistance[bin]; }
+    float getShadowStart(int bin) const { return shadowStart[bin]; }
+    float getOriginX() const { return originX; }
+    float getOriginY() const { return originY; }
+    bool hasOccluders() const { return hasOccluder; }
+};
+
+#endif // VISIBILITY_MAP_H
@@ -34,6 +34,9 @@ Zombie::Zombie(
     lastTargetX(-1),
     lastTargetY(-1) {
     
+    // 尸群之间互相绕行（见CrowdSteering）
+    setCrowdSteering(true);
+    
     // 根据丧尸类型设置属性
     switch (zombieType) {
         case ZombieType::NORMAL:
@@ -135,23 +138,8 @@ void Zombie::update(float deltaTime) {
         // 获取游戏中的所有实体
         Game* game = Game::getInstance();
         if (game) {
-            // 获取所有可能的目标（玩家和其他生物）
-            std::vector<Entity*> potentialTargets;
-            
-            // 添加玩家
-            if (game->getPlayer()) {
-                potentialTargets.push_back(game->getPlayer());
-            }
-            
-            // 添加其他生物（非丧尸）
-            for (const auto& creature : game->getCreatures()) {
-                if (creature.get() != this && !creature->hasFlag(EntityFlag::IS_ZOMBIE)) {
-                    potentialTargets.push_back(creature.get());
-                }
-            }
-            
-            // 检查视觉感知
-            std::vector<Entity*> visibleTargets = getVisibleEntities(potentialTargets);
+            // 检查视觉感知（本帧的玩家和非丧尸生物由Game统一构建）
+            std::vector<Entity*> visibleTargets = getVisibleEntities(game->getZombieTargets());
             
             if (!visibleTargets.empty()) {
                 // 如果看到任何非丧尸生物，追逐最近的那个
@@ -312,22 +300,8 @@ void Zombie::handleInvestigatingState(float deltaTime) {
     // 首先检查是否有新的视觉目标
     Game* game = Game::getInstance();
     if (game) {
-        std::vector<Entity*> potentialTargets;
-        
-        // 添加玩家
-        if (game->getPlayer()) {
-            potentialTargets.push_back(game->getPlayer());
-        }
-        
-        // 添加其他生物（非丧尸）
-        for (const auto& creature : game->getCreatures()) {
-            if (creature.get() != this && !creature->hasFlag(EntityFlag::IS_ZOMBIE)) {
-                potentialTargets.push_back(creature.get());
-            }
-        }
-        
-        // 检查视觉感知
-        std::vector<Entity*> visibleTargets = getVisibleEntities(potentialTargets);
+        // 检查视觉感知（本帧的玩家和非丧尸生物由Game统一构建）
+        std::vector<Entity*> visibleTargets = getVisibleEntities(game->getZombieTargets());
         
         if (!visibleTargets.empty()) {
             // 找到新目标，立即切换到追逐状态
@@ -391,7 +365,7 @@ void Zombie::handleChasingState(float deltaTime) {
     if (visualTarget) {
         // 检查目标是否仍然可见
         if (canSeeEntity(visualTarget)) {
-            moveToPosition(visualTarget->getX(), visualTarget->getY(), deltaTime);
+            moveToPositionWithPathfinding(visualTarget->getX(), visualTarget->getY(), deltaTime);
             
             // 如果接近目标，切换到攻击状态
             float distance = distanceToTarget(visualTarget->getX(), visualTarget->getY());
@@ -407,22 +381,8 @@ void Zombie::handleChasingState(float deltaTime) {
             // 重新检测是否有其他可见目标
             Game* game = Game::getInstance();
             if (game) {
-                std::vector<Entity*> potentialTargets;
-                
-                // 添加玩家
-                if (game->getPlayer()) {
-                    potentialTargets.push_back(game->getPlayer());
-                }
-                
-                // 添加其他生物（非丧尸）
-                for (const auto& creature : game->getCreatures()) {
-                    if (creature.get() != this && !creature->hasFlag(EntityFlag::IS_ZOMBIE)) {
-                        potentialTargets.push_back(creature.get());
-                    }
-                }
-                
-                // 检查视觉感知
-                std::vector<Entity*> visibleTargets = getVisibleEntities(potentialTargets);
+                // 检查视觉感知（本帧的玩家和非丧尸生物由Game统一构建）
+                std::vector<Entity*> visibleTargets = getVisibleEntities(game->getZombieTargets());
                 
                 if (!visibleTargets.empty()) {
                     // 找到新目标，继续追逐
@@ -652,12 +612,23 @@ void Zombie::moveToPosition(float targetX, float targetY, float deltaTime) {
 }
 
 // 新增：使用寻路系统移动到目标
+// 优先采样共享流场（追击同一目标的丧尸共用一次计算），超出智能程度允许的范围时退回单独寻路
 void Zombie::moveToPositionWithPathfinding(float targetX, float targetY, float deltaTime) {
     // 设置寻路目标
     setPathTarget(targetX, targetY);
     
-    // 使用寻路系统
     Game* game = Game::getInstance();
+    FlowFieldService* flowFields = game ? game->getFlowFields() : nullptr;
+    float dirX, dirY, moveCost;
+    if (flowFields && flowFields->sampleDirection(targetX, targetY, x, y, pathfindingIntelligence, dirX, dirY, moveCost)) {
+        // 应用地形移动耗时修正，让物理系统处理实际移动
+        isFollowingPath = true;
+        float desiredSpeed = speed / moveCost;
+        setDesiredVelocity(dirX * desiredSpeed, dirY * desiredSpeed);
+        return;
+    }
+    
+    // 使用寻路系统
     if (game && game->getPathfinder()) {
         updatePathfinding(deltaTime, game->getPathfinder());
     }